@@ -0,0 +1,412 @@
+// Measures parser and emitter throughput on synthetic headers.
+// Results are written as JSON so runs can be compared by scripts, i.e. before upgrading a dependency:
+//   bench_codegen --classes 200 --exports 40 -o before.json
+
+#include "code_gen/class_parser.h"
+#include "code_gen/defines.h"
+#include "code_gen/file_utils.h"
+#include "code_gen/generator.h"
+#include "code_gen/lexer.h"
+#include "code_gen/output_buffer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Private structs
+typedef struct bench_options {
+    int class_count;        // Top level classes
+    int depth;              // Each top level class holds a chain of nested classes this deep (1 = no nesting)
+    int export_count;       // Exports per class
+    int group_size;         // Exports per group, 0 for no groups
+    int method_count;       // Inline methods per class
+    int method_lines;       // Statements in each method body
+    int comment_lines;      // Comment lines before each export
+    int iterations;
+    unsigned int seed;
+    const char* directory;  // Where the header and generated source are written
+    const char* output_path; // JSON results. Defaults to stdout
+} bench_options_t;
+
+typedef enum bench_phase {
+    BENCH_PHASE_READ,
+    BENCH_PHASE_TOKENIZE,
+    BENCH_PHASE_PARSE,
+    BENCH_PHASE_EMIT,
+    BENCH_PHASE_WRITE,
+    BENCH_PHASE_COUNT,
+} bench_phase_t;
+
+typedef struct phase_result {
+    double best_seconds;
+    double total_seconds;
+    size_t bytes; // Input bytes for read, tokenize and parse. Generated bytes for emit and write
+} phase_result_t;
+
+// Private data
+// Classes are generated recursively, one level of nesting per call
+#define MAX_DEPTH 64
+
+static const char* phase_names[BENCH_PHASE_COUNT] = { "read", "tokenize", "parse", "emit", "write", };
+
+// Wrapped types that aren't in export_type_aliases
+static const char* wrapped_types[] = {
+    "Ref<Texture2D>",
+    "godot::Ref<PackedScene>",
+    "Node3D*",
+    "TypedArray<Node3D>",
+    "TypedArray<Ref<Texture2D>>",
+    "const Node*",
+};
+static const int wrapped_type_count = sizeof(wrapped_types) / sizeof(const char*);
+
+// Private functions
+static b8 parse_arguments(int argc, char** argv, bench_options_t* options);
+static int collect_types(const char** types, int capacity);
+static void generate_header(const bench_options_t* options, output_buffer_t* out);
+static void generate_class(const bench_options_t* options, output_buffer_t* out, const char** types, int type_count,
+        const char* name, int depth, int indent, unsigned int* random_state);
+static void append_indent(output_buffer_t* out, int indent);
+static void append_int(output_buffer_t* out, long value);
+static unsigned int next_random(unsigned int* state);
+static double now_seconds(void);
+static void record_phase(phase_result_t* result, double seconds);
+static void write_results(FILE* file, const bench_options_t* options, size_t input_size, int export_count, const phase_result_t* results);
+
+int main(int argc, char** argv) {
+    bench_options_t options = {
+        .class_count = 100,
+        .depth = 2,
+        .export_count = 32,
+        .group_size = 8,
+        .method_count = 4,
+        .method_lines = 8,
+        .comment_lines = 1,
+        .iterations = 10,
+        .seed = 1,
+        .directory = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp",
+    };
+    if (!parse_arguments(argc, argv, &options)) {
+        return -1;
+    }
+
+    // Write the synthetic header
+    output_buffer_t header;
+    output_buffer_init(&header);
+    generate_header(&options, &header);
+
+    char header_path[4096];
+    char output_path[4096];
+    snprintf(header_path, sizeof(header_path), "%s/bench_codegen_%d.h", options.directory, (int)getpid());
+    snprintf(output_path, sizeof(output_path), "%s/bench_codegen_%d.cpp", options.directory, (int)getpid());
+    if (!write_file_if_changed(header_path, header.data, header.size, NULL)) {
+        fprintf(stderr, "Failed to write '%s'.\n", header_path);
+        output_buffer_free(&header);
+        return -1;
+    }
+    size_t input_size = header.size;
+    output_buffer_free(&header);
+
+    generator_t generator;
+    generator_init(&generator);
+
+    phase_result_t results[BENCH_PHASE_COUNT] = {};
+    results[BENCH_PHASE_READ].bytes = input_size;
+    results[BENCH_PHASE_TOKENIZE].bytes = input_size;
+    results[BENCH_PHASE_PARSE].bytes = input_size;
+
+    b8 success = true;
+    int export_count = 0;
+    volatile long sink = 0;
+    for (int iteration = 0; iteration < options.iterations && success; iteration++) {
+        // Read: map the header and fault in every page
+        double start = now_seconds();
+        success = generator_load_file(&generator, header_path);
+        long page_sum = 0;
+        for (long i = 0; success && i < generator.text_length; i += 4096) {
+            page_sum += generator.text[i];
+        }
+        sink += page_sum;
+        record_phase(&results[BENCH_PHASE_READ], now_seconds() - start);
+
+        // Tokenize: the lexer on its own
+        start = now_seconds();
+        lexer_t lexer;
+        lexer_init(&lexer, generator.text, generator.text_length);
+        token_t token;
+        long token_count = 0;
+        while (success && lexer_next(&lexer, &token)) {
+            token_count++;
+        }
+        sink += token_count;
+        record_phase(&results[BENCH_PHASE_TOKENIZE], now_seconds() - start);
+
+        // Parse: tokenizing again, class_parse_marker for every marker and export resolution
+        start = now_seconds();
+        success = success && generator_parse(&generator, header_path);
+        record_phase(&results[BENCH_PHASE_PARSE], now_seconds() - start);
+
+        export_count = 0;
+        for (int i = 0; success && i < generator.class_count; i++) {
+            export_count += generator.classes[i].exports.count;
+        }
+
+        // Emit: class_write_exports for every class
+        const char* output = NULL;
+        size_t output_size = 0;
+        start = now_seconds();
+        success = success && generator_emit(&generator, header_path, &output, &output_size);
+        record_phase(&results[BENCH_PHASE_EMIT], now_seconds() - start);
+        results[BENCH_PHASE_EMIT].bytes = output_size;
+        results[BENCH_PHASE_WRITE].bytes = output_size;
+
+        // Write: always a real write, an unchanged file would only be compared
+        unlink(output_path);
+        start = now_seconds();
+        success = success && write_file_if_changed(output_path, output, output_size, NULL);
+        record_phase(&results[BENCH_PHASE_WRITE], now_seconds() - start);
+    }
+
+    generator_shutdown(&generator);
+    unlink(header_path);
+    unlink(output_path);
+
+    if (!success) {
+        fprintf(stderr, "Failed to generate the synthetic header.\n");
+        return -1;
+    }
+
+    FILE* file = options.output_path ? fopen(options.output_path, "w") : stdout;
+    if (!file) {
+        fprintf(stderr, "Failed to open '%s'.\n", options.output_path);
+        return -1;
+    }
+    write_results(file, &options, input_size, export_count, results);
+    if (file != stdout) {
+        fclose(file);
+    }
+
+    return 0;
+}
+
+// Private functions
+static b8 parse_arguments(int argc, char** argv, bench_options_t* options) {
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Missing value for '%s'.\n", argv[i]);
+            return false;
+        }
+
+        const char* value = argv[i + 1];
+        if (strcmp(argv[i], "--classes") == 0) {
+            options->class_count = atoi(value);
+        } else if (strcmp(argv[i], "--depth") == 0) {
+            options->depth = atoi(value);
+        } else if (strcmp(argv[i], "--exports") == 0) {
+            options->export_count = atoi(value);
+        } else if (strcmp(argv[i], "--group-size") == 0) {
+            options->group_size = atoi(value);
+        } else if (strcmp(argv[i], "--methods") == 0) {
+            options->method_count = atoi(value);
+        } else if (strcmp(argv[i], "--method-lines") == 0) {
+            options->method_lines = atoi(value);
+        } else if (strcmp(argv[i], "--comments") == 0) {
+            options->comment_lines = atoi(value);
+        } else if (strcmp(argv[i], "--iterations") == 0) {
+            options->iterations = atoi(value);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            options->seed = (unsigned int)atol(value);
+        } else if (strcmp(argv[i], "--dir") == 0) {
+            options->directory = value;
+        } else if (strcmp(argv[i], "-o") == 0) {
+            options->output_path = value;
+        } else {
+            fprintf(stderr, "Unknown option '%s'.\n", argv[i]);
+            return false;
+        }
+        i++;
+    }
+
+    if (options->depth < 1) {
+        options->depth = 1;
+    }
+    if (options->depth > MAX_DEPTH) {
+        fprintf(stderr, "--depth must be at most %d.\n", MAX_DEPTH);
+        return false;
+    }
+    if (options->iterations < 1) {
+        options->iterations = 1;
+    }
+    return true;
+}
+
+// Every plain variant alias plus the wrapped resource, node and typed array forms
+static int collect_types(const char** types, int capacity) {
+    int type_count = 0;
+    for (int i = 0; i < export_type_alias_count; i++) {
+        const export_type_alias_t* alias = &export_type_aliases[i];
+        if (alias->type == EXPORT_TYPE_NULL || alias->type == EXPORT_TYPE_RESOURCE || alias->type == EXPORT_TYPE_NODE ||
+                alias->type == EXPORT_TYPE_TYPED_ARRAY || alias->type == EXPORT_TYPE_TYPED_RESOURCE_ARRAY) {
+            continue;
+        }
+
+        for (int j = 0; j < alias->alias_count && type_count < capacity; j++) {
+            types[type_count++] = alias->aliases[j];
+        }
+    }
+    for (int i = 0; i < wrapped_type_count && type_count < capacity; i++) {
+        types[type_count++] = wrapped_types[i];
+    }
+
+    return type_count;
+}
+
+static void generate_header(const bench_options_t* options, output_buffer_t* out) {
+    const char* types[256];
+    int type_count = collect_types(types, sizeof(types) / sizeof(const char*));
+    unsigned int random_state = options->seed;
+
+    output_append_literal(out, "// Synthetic header generated by bench_codegen\n#pragma once\n\n");
+    output_append_literal(out, "#include <godot_cpp/classes/node3d.hpp>\n\nnamespace wander {\n");
+    for (int i = 0; i < options->class_count; i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "Bench%d", i);
+        generate_class(options, out, types, type_count, name, options->depth, 0, &random_state);
+        output_append_literal(out, "\n");
+    }
+    output_append_literal(out, "}\n");
+}
+
+static void generate_class(const bench_options_t* options, output_buffer_t* out, const char** types, int type_count,
+        const char* name, int depth, int indent, unsigned int* random_state) {
+    append_indent(out, indent);
+    output_append_literal(out, "class ");
+    output_append_string(out, name);
+    output_append_literal(out, " : public Node3D {\n");
+    append_indent(out, indent + 1);
+    output_append_literal(out, "GDCLASS(");
+    output_append_string(out, name);
+    output_append_literal(out, ", Node3D)\n");
+    append_indent(out, indent);
+    output_append_literal(out, "protected:\n");
+    append_indent(out, indent + 1);
+    output_append_literal(out, "static void _bind_methods();\n\n");
+    append_indent(out, indent);
+    output_append_literal(out, "public:\n");
+
+    for (int i = 0; i < options->export_count; i++) {
+        if (options->group_size > 0 && i % options->group_size == 0) {
+            append_indent(out, indent + 1);
+            output_append_literal(out, "GD_GROUP(Group ");
+            append_int(out, i / options->group_size);
+            output_append_literal(out, ", group");
+            append_int(out, i / options->group_size);
+            output_append_literal(out, "_);\n");
+        }
+
+        for (int j = 0; j < options->comment_lines; j++) {
+            append_indent(out, indent + 1);
+            output_append_literal(out, "// Exported to the editor. Changing it at runtime takes effect on the next frame.\n");
+        }
+
+        append_indent(out, indent + 1);
+        output_append_literal(out, "GD_EXPORT(");
+        output_append_string(out, types[next_random(random_state) % type_count]);
+        output_append_literal(out, ", export_");
+        append_int(out, i);
+        output_append_literal(out, ");\n");
+    }
+
+    for (int i = 0; i < options->method_count; i++) {
+        output_append_literal(out, "\n");
+        append_indent(out, indent + 1);
+        output_append_literal(out, "int method_");
+        append_int(out, i);
+        output_append_literal(out, "(int value) const {\n");
+        append_indent(out, indent + 2);
+        output_append_literal(out, "int total = value;\n");
+        for (int j = 0; j < options->method_lines; j++) {
+            append_indent(out, indent + 2);
+            output_append_literal(out, "if (total > ");
+            append_int(out, j);
+            output_append_literal(out, ") { total = total * 3 + value; } else { total -= 1; }\n");
+        }
+        append_indent(out, indent + 2);
+        output_append_literal(out, "return total;\n");
+        append_indent(out, indent + 1);
+        output_append_literal(out, "}\n");
+    }
+
+    if (depth > 1) {
+        // Names grow by "_<depth>" at every level, so the buffer is sized from the outer name
+        size_t length = strlen(name) + sizeof("_") + 11;
+        char* nested_name = malloc(length);
+        snprintf(nested_name, length, "%s_%d", name, depth - 1);
+        output_append_literal(out, "\n");
+        generate_class(options, out, types, type_count, nested_name, depth - 1, indent + 1, random_state);
+        free(nested_name);
+    }
+
+    append_indent(out, indent);
+    output_append_literal(out, "};\n");
+}
+
+static void append_indent(output_buffer_t* out, int indent) {
+    for (int i = 0; i < indent; i++) {
+        output_append_literal(out, "    ");
+    }
+}
+
+static void append_int(output_buffer_t* out, long value) {
+    char digits[32];
+    int length = snprintf(digits, sizeof(digits), "%ld", value);
+    output_append(out, digits, length);
+}
+
+// xorshift32, so headers are the same for a seed on every platform
+static unsigned int next_random(unsigned int* state) {
+    unsigned int x = *state ? *state : 1;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static double now_seconds(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+static void record_phase(phase_result_t* result, double seconds) {
+    if (result->total_seconds == 0 || seconds < result->best_seconds) {
+        result->best_seconds = seconds;
+    }
+    result->total_seconds += seconds;
+}
+
+static void write_results(FILE* file, const bench_options_t* options, size_t input_size, int export_count, const phase_result_t* results) {
+    fprintf(file, "{\n");
+    fprintf(file, "  \"config\": {\"classes\": %d, \"depth\": %d, \"exports\": %d, \"group_size\": %d, \"methods\": %d, "
+            "\"method_lines\": %d, \"comments\": %d, \"iterations\": %d, \"seed\": %u},\n",
+            options->class_count, options->depth, options->export_count, options->group_size, options->method_count,
+            options->method_lines, options->comment_lines, options->iterations, options->seed);
+    fprintf(file, "  \"input_bytes\": %zu,\n", input_size);
+    fprintf(file, "  \"export_count\": %d,\n", export_count);
+    fprintf(file, "  \"phases\": [\n");
+
+    // Rates use the best iteration, the least disturbed by the rest of the machine
+    for (int i = 0; i < BENCH_PHASE_COUNT; i++) {
+        const phase_result_t* result = &results[i];
+        double best = result->best_seconds > 0 ? result->best_seconds : 1e-9;
+        fprintf(file, "    {\"name\": \"%s\", \"best_seconds\": %.9f, \"mean_seconds\": %.9f, \"bytes\": %zu, "
+                "\"mb_per_second\": %.3f, \"exports_per_second\": %.1f}%s\n",
+                phase_names[i], result->best_seconds, result->total_seconds / options->iterations, result->bytes,
+                result->bytes / best / (1024.0 * 1024.0), export_count / best, i + 1 < BENCH_PHASE_COUNT ? "," : "");
+    }
+
+    fprintf(file, "  ]\n}\n");
+}
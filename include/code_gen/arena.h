@@ -0,0 +1,28 @@
+#pragma once
+
+#include "code_gen/defines.h"
+
+#include <stddef.h>
+
+typedef struct arena_block arena_block_t;
+
+// Bump allocator for data that lives as long as one file.
+// Nothing is freed individually, the whole arena is reset once the file has been generated.
+// The first block is kept on reset so processing many files doesn't reallocate for each one.
+typedef struct arena {
+    arena_block_t* first;
+    arena_block_t* current;
+} arena_t;
+
+void arena_init(arena_t* arena);
+void arena_free(arena_t* arena);
+void arena_reset(arena_t* arena);
+
+// Returns uninitialized memory aligned for any type. Aborts if memory runs out.
+void* arena_alloc(arena_t* arena, size_t size);
+
+// Resizes an allocation. Grows in place when it is the last allocation, otherwise copies it.
+void* arena_grow(arena_t* arena, void* data, size_t old_size, size_t new_size);
+
+// Copies length characters of text into a new NUL terminated string
+char* arena_copy_string(arena_t* arena, const char* text, size_t length);
@@ -1,6 +1,12 @@
 #pragma once
 
-#include <stdio.h>
+#include "code_gen/arena.h"
+#include "code_gen/defines.h"
+#include "code_gen/diagnostics.h"
+#include "code_gen/lexer.h"
+#include "code_gen/output_buffer.h"
+#include "code_gen/string_table.h"
+
 static const char* keywords[] = {
     "class",
     "struct",
@@ -8,11 +14,6 @@ static const char* keywords[] = {
 };
 static const int keyword_count = sizeof(keywords) / sizeof(const char*);
 
-typedef struct export {
-    char type[128];
-    char name[64];
-} export_t;
-
 typedef enum export_type {
     EXPORT_TYPE_NULL,
 
@@ -70,26 +71,83 @@ typedef enum export_type {
     EXPORT_TYPE_PACKED_VECTOR4_ARRAY,
 } export_type_t;
 
+// What a setter does after assigning a changed value. Setters of notifying exports skip equal values entirely
+typedef enum export_notify {
+    EXPORT_NOTIFY_NONE,
+    EXPORT_NOTIFY_IMMEDIATE, // GD_EXPORT_NOTIFY, the callback runs inside the setter
+    EXPORT_NOTIFY_DEFERRED,  // GD_EXPORT_NOTIFY_DEFERRED, the callback runs once per frame no matter how often the value changed
+} export_notify_t;
+
+// Set on an export by its marker or by resolving its type
+typedef enum export_flag {
+    EXPORT_FLAG_RESOURCE = 1 << 0,         // Ref<T>
+    EXPORT_FLAG_POINTER = 1 << 1,          // T*
+    EXPORT_FLAG_TYPED_ARRAY = 1 << 2,      // TypedArray<T>
+    EXPORT_FLAG_PACKED_ACCESSORS = 1 << 3, // GD_EXPORT_PACKED, spans over the storage of a Packed*Array
+} export_flag_t;
+
+#define EXPORT_TYPE_FLAGS (EXPORT_FLAG_RESOURCE | EXPORT_FLAG_POINTER | EXPORT_FLAG_TYPED_ARRAY)
+
+// A raw type string after trimming qualifiers and wrappers and looking it up
+typedef struct type_info {
+    u8 export_type;   // export_type_t, EXPORT_TYPE_NULL until resolved
+    u8 flags;         // The EXPORT_TYPE_FLAGS that apply
+    string_id_t hint; // Type without qualifiers or wrappers (i.e. Texture2D for Ref<Texture2D>)
+} type_info_t;
+
+// Strings and resolved types shared by every class of a file, allocated from the file's arena.
+// Each distinct type string is normalized once no matter how many exports use it
+typedef struct class_symbols {
+    string_table_t strings;
+    type_info_t* types; // Indexed by the string id of a raw type
+    u32 type_capacity;
+} class_symbols_t;
+
+// Exports as one array per field, all indexed by export, so passes over one field read only that field
+typedef struct export_table {
+    string_id_t* names;
+    string_id_t* types;     // As written, i.e. "const Ref<Texture2D>"
+    string_id_t* callbacks; // Notify callback, STRING_ID_EMPTY without notify
+    u8* notify;             // export_notify_t
+    u8* flags;              // export_flag_t. Only EXPORT_FLAG_PACKED_ACCESSORS until resolved
+    int* groups;            // Index of the last group declared before the export, -1 if there is none
+    int* subgroups;         // Same for subgroups
+    long* offsets;          // Where the export's type starts in the header, for diagnostics. Not kept in the IR
+
+    // Filled in by class_resolve_exports
+    u8* export_types;       // export_type_t
+    string_id_t* hints;
+
+    int count;
+    int capacity;
+} export_table_t;
+
 typedef struct group {
-    int start_export_index;
     const char* name;
     const char* prefix;
 } group_t;
 
-#define MAX_CLASS_EXPORTS 1024
-#define MAX_GROUPS 128
-#define MAX_SUBGROUPS 128
+// Everything a class holds is allocated from its arena, which is owned by the caller and reset per file.
+// Arrays grow as needed so there's no limit on the number of exports or groups.
 typedef struct class {
-    char name[64];
-    export_t exports[MAX_CLASS_EXPORTS];
-    group_t groups[MAX_GROUPS];
-    group_t subgroups[MAX_SUBGROUPS];
-    int export_count;
+    arena_t* arena;
+    class_symbols_t* symbols;
+    const char* name;
+    export_table_t exports;
+    group_t* groups;
+    group_t* subgroups;
     int group_count;
+    int group_capacity;
     int subgroup_count;
+    int subgroup_capacity;
     int generate;
 } class_t;
 
+typedef struct emit_options {
+    b8 inline_accessors; // Accessors are written by class_write_inline_accessors instead, only _bind_methods is emitted
+    b8 property_table;   // _bind_methods registers properties and groups from a constant table with a single loop
+} emit_options_t;
+
 typedef struct export_type_alias {
     export_type_t type;
     int alias_count;
@@ -99,7 +157,7 @@ typedef struct export_type_alias {
 const static export_type_alias_t export_type_aliases[] = {
     (export_type_alias_t) {
         .type = EXPORT_TYPE_NULL,
-        .alias_count = 1,
+        .alias_count = 0,
         .aliases = (const char*[]) {
         },
     },
@@ -428,5 +486,19 @@ const static export_type_alias_t export_type_aliases[] = {
 };
 const static int export_type_alias_count = sizeof(export_type_aliases) / sizeof(export_type_alias_t);
 
-void class_write_exports(class_t* class, const char* source_path, FILE* file);
-void class_parse_line(class_t* class, const char* line);
+// Starts an empty set of symbols for a file. Call again after the arena is reset
+void class_symbols_init(class_symbols_t* symbols, arena_t* arena);
+// Clears all parsed data so the class can be reused.
+// The old arrays are dropped, not freed, and go away when the arena is reset.
+void class_reset(class_t* class, arena_t* arena, class_symbols_t* symbols);
+// Makes room for count exports. The table's arrays are allocated from the class arena
+void class_reserve_exports(class_t* class, int count);
+// Resolves the export type and hint of every export. Every unrecognized type is reported before failing
+b8 class_resolve_exports(class_t* class, diagnostics_t* diagnostics);
+// Emits the generated source for a class with resolved exports
+b8 class_write_exports(const class_t* class, const char* source_path, const emit_options_t* options, output_buffer_t* out);
+// Emits the getters and setters of a class as inline definitions, for a companion file included by its header
+void class_write_inline_accessors(const class_t* class, output_buffer_t* out);
+// Parses the arguments of a marker token (GD_EXPORT, GD_GROUP, ...) read from lexer, up to its closing parenthesis.
+// Malformed markers are reported and skipped, the lexer is left where parsing can carry on
+b8 class_parse_marker(class_t* class, lexer_t* lexer, const token_t* marker, diagnostics_t* diagnostics);
@@ -1,6 +1,9 @@
 #pragma once
 
 typedef unsigned char b8;
+typedef unsigned char u8;
+typedef unsigned int u32;
+typedef unsigned long long u64;
 #define true 1
 #define false 0
 
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "code_gen/defines.h"
+
+#define DEPFILE_EXTENSION ".d"
+
+// Writes a Make style depfile ("target...: input..."), as read by Ninja's and CMake's DEPFILE. Files written
+// alongside the generated source (companions, IR) are listed as extra targets so they are rebuilt with it.
+// Paths are escaped so spaces, '#' and '$' survive. The file is only rewritten when its contents change.
+b8 depfile_write(const char* depfile_path, const char** targets, int target_count, const char** inputs, int input_count);
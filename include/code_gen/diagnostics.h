@@ -0,0 +1,60 @@
+#pragma once
+
+#include "code_gen/defines.h"
+#include "code_gen/output_buffer.h"
+
+// Errors and warnings found while parsing a header. Parsing carries on after an error so every problem in a file
+// is reported in one run. Each diagnostic keeps the offset it was found at and is printed compiler style once the
+// file is done, i.e. "src/player.h:12:15: error: Unrecognized export type 'Vector9'."
+typedef enum diagnostic_severity {
+    DIAGNOSTIC_WARNING,
+    DIAGNOSTIC_ERROR,
+} diagnostic_severity_t;
+
+typedef struct diagnostic {
+    diagnostic_severity_t severity;
+    long offset;          // Into the file's text, -1 if the diagnostic is about the whole file
+    size_t message_start; // Into the message buffer
+    int index;            // Order of reporting, keeps diagnostics at the same offset in order
+} diagnostic_t;
+
+// Diagnostics of the file a generator is working on. Buffers are kept between files
+typedef struct diagnostics {
+    const char* path;
+    const char* text;
+    long text_length;
+
+    diagnostic_t* items;
+    int count;
+    int capacity;
+    output_buffer_t messages; // NUL terminated messages
+    int error_count;
+
+    // Optional. Flushed diagnostics are appended here instead of being written to stderr, and counted below
+    // instead of in the process totals
+    output_buffer_t* capture;
+    int captured_error_count;
+    int captured_warning_count;
+} diagnostics_t;
+
+void diagnostics_init(diagnostics_t* diagnostics);
+void diagnostics_free(diagnostics_t* diagnostics);
+
+// Starts collecting for a file. The path and text must stay valid until diagnostics_flush
+void diagnostics_begin(diagnostics_t* diagnostics, const char* path, const char* text, long text_length);
+
+void diagnostics_report(diagnostics_t* diagnostics, diagnostic_severity_t severity, long offset, const char* format, ...) __attribute__((format(printf, 4, 5)));
+
+#define diagnostics_error(diagnostics, offset, ...) diagnostics_report(diagnostics, DIAGNOSTIC_ERROR, offset, __VA_ARGS__)
+#define diagnostics_warn(diagnostics, offset, ...) diagnostics_report(diagnostics, DIAGNOSTIC_WARNING, offset, __VA_ARGS__)
+
+// Writes the file's diagnostics to stderr (or the capture buffer) in source order with a single write, adds them
+// to the process totals and clears them. Safe to call from several threads with their own diagnostics
+void diagnostics_flush(diagnostics_t* diagnostics);
+
+// Writes diagnostics rendered by another process (the codegen server) to stderr and adds them to the process totals
+void diagnostics_forward(const char* text, size_t size, int error_count, int warning_count);
+
+// Prints how many errors and warnings were flushed by every thread, i.e. "3 errors and 1 warning generated.".
+// Prints nothing if there were none
+void diagnostics_print_summary(void);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "code_gen/defines.h"
+#include "code_gen/class_parser.h"
+
+// Resolves a trimmed type string (i.e. "float", "Vector3") to its export type with a single probe.
+// The table is built from export_type_aliases plus any registered aliases using a seed that
+// gives every alias its own slot. Returns EXPORT_TYPE_NULL for unknown types.
+export_type_t export_types_lookup(const char* type, int length);
+
+// Adds a project specific alias (i.e. real_t) that resolves to the same export type as target,
+// which must already be a known alias (i.e. float). Must be called before any worker threads start.
+b8 export_types_register_alias(const char* alias, const char* target);
+
+// Registers an alias given as "alias=target".
+b8 export_types_register_alias_pair(const char* pair);
+
+// Returns true if setters take the type by value. Scalars, RIDs and pointers are passed by value,
+// everything else (strings, math types, containers, Ref<>, Object) by const reference.
+// Must match the gd_export_param trait used by GD_EXPORT (see the Readme).
+b8 export_types_pass_by_value(export_type_t type);
+
+// Returns the element type of a Packed*Array (i.e. "float" for PackedFloat32Array), or NULL for any other type.
+// Must match the gd_packed_element alias used by GD_EXPORT_PACKED (see the Readme).
+const char* export_types_packed_element(export_type_t type);
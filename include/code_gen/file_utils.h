@@ -0,0 +1,11 @@
+#pragma once
+
+#include "code_gen/defines.h"
+
+#include <stddef.h>
+
+// Writes data to path unless the file already holds exactly the same bytes, in which case
+// it is left untouched so its modification time doesn't trigger rebuilds.
+// Changed files are written to a temporary file and renamed over path, so readers never see a
+// partially written file. out_changed (optional) reports whether the file was rewritten.
+b8 write_file_if_changed(const char* path, const char* data, size_t size, b8* out_changed);
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "code_gen/arena.h"
+#include "code_gen/defines.h"
+#include "code_gen/class_parser.h"
+#include "code_gen/diagnostics.h"
+#include "code_gen/output_buffer.h"
+#include "code_gen/trace.h"
+
+#include <stddef.h>
+
+// Companion files replace the output's extension, i.e. player.cpp -> player.gen.inl
+#define INLINE_EXTENSION ".gen.inl"
+
+// A class that is currently open while parsing. Nested classes get their own scope,
+// so exports after a nested class still belong to the outer one.
+typedef struct class_scope {
+    class_t class;
+    int indent;
+    trace_span_t span;
+} class_scope_t;
+
+// Holds all state needed to convert a header into its generated source.
+// Buffers are kept between files so batch runs don't reallocate for every header.
+// Generators share no state, so each worker thread can own one.
+typedef struct generator {
+    // Input text is a read-only view of the mapped header and is not NUL terminated
+    const char* text;
+    long text_length;
+    void* mapping;
+    size_t mapping_size;
+
+    // Parsed data for the current file. Reset at the start of every render
+    arena_t arena;
+    class_symbols_t symbols; // Strings and resolved types of the current file's classes. Allocated from the arena
+
+    // Errors and warnings of the file being parsed, printed once it has been parsed
+    diagnostics_t diagnostics;
+
+    // Generated source for the last render
+    output_buffer_t output;
+    output_buffer_t inline_output; // Companion for the last generator_write_inline
+
+    // Need to save a heirarchy for subclasses to work. Allocated from the arena
+    class_scope_t* class_heirarchy;
+    int class_heirarchy_capacity;
+
+    // Classes of the current file in the order they are emitted, with resolved exports.
+    // Filled by parsing the header or by loading its IR. Allocated from the arena
+    class_t* classes;
+    int class_count;
+    int class_capacity;
+
+    // Options, set after generator_init
+    b8 write_ir; // generator_process_file also writes the IR next to the output
+    b8 read_ir;  // generator_process_file emits from the IR next to the output instead of parsing the header
+    b8 write_depfile; // generator_process_file writes a depfile listing the output's inputs
+    const char* depfile_path; // Optional. Defaults to the output path + DEPFILE_EXTENSION
+    b8 write_inline; // Accessors go to an inline companion instead of the generated source
+    b8 property_table; // _bind_methods registers properties from a constant table
+} generator_t;
+
+void generator_init(generator_t* generator);
+void generator_shutdown(generator_t* generator);
+
+// Maps the header at input_path as the generator's text. The mapping stays valid until the next load.
+b8 generator_load_file(generator_t* generator, const char* input_path);
+
+// Uses text as the generator's input without copying it, for headers that are already in memory.
+// text doesn't need to be NUL terminated and must stay valid until the next load
+void generator_load_text(generator_t* generator, const char* text, long length);
+
+// Quick check on the raw loaded text. Returns false if the header can't contain anything to generate.
+b8 generator_may_have_exports(const generator_t* generator);
+
+// Parses the loaded text and resolves the exports of every class, without emitting anything.
+// Parsing carries on after errors, every error and warning in the file is printed before returning
+b8 generator_parse(generator_t* generator, const char* input_path);
+
+// Generates source for the loaded text. input_path is only used for the emitted include and errors.
+// On success out_output points into the generator's output buffer and stays valid until the next render.
+b8 generator_render(generator_t* generator, const char* input_path, const char** out_output, size_t* out_size);
+
+// Emits source for the classes from the last render or IR load, without parsing anything
+b8 generator_emit(generator_t* generator, const char* source_path, const char** out_output, size_t* out_size);
+
+// Writes the classes from the last render as IR. source_path is stored for the emitted include
+b8 generator_write_ir(generator_t* generator, const char* source_path, const char* ir_path);
+
+// Builds the inline companion of the classes from the last render or IR load in memory (see generator_write_inline).
+// out_output points into the generator's inline buffer and stays valid until the next call
+void generator_emit_inline(generator_t* generator, const char* source_path, const char** out_output, size_t* out_size);
+
+// Writes the getters and setters of the classes from the last render or IR load as inline definitions to
+// the companion of output_path. The header at source_path includes it after its classes so other translation
+// units can inline property access
+b8 generator_write_inline(generator_t* generator, const char* source_path, const char* output_path);
+
+// Returns the companion path for output_path (see INLINE_EXTENSION). The caller frees it
+char* generator_inline_path(const char* output_path);
+
+// Maps an IR file and loads its classes. Strings point into the mapping, which stays valid until the next load.
+// out_source_path receives the path of the header the IR was generated from
+b8 generator_load_ir(generator_t* generator, const char* ir_path, const char** out_source_path);
+
+// Parses the header at input_path and writes the generated source to output_path.
+// With write_ir set, the IR is also written to output_path + IR_EXTENSION. With read_ir set the header
+// isn't read at all and the source is emitted from that IR file. With write_depfile set, a depfile naming the
+// header (or the IR file) as the output's input is written as well. With write_inline set, the accessors are
+// written to the companion of output_path instead.
+// Returns false if the file could not be processed. Errors are logged, never fatal.
+b8 generator_process_file(generator_t* generator, const char* input_path, const char* output_path);
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "code_gen/arena.h"
+#include "code_gen/class_parser.h"
+#include "code_gen/defines.h"
+#include "code_gen/output_buffer.h"
+
+#include <stddef.h>
+
+// Binary intermediate representation of a parsed header: every class with its resolved exports,
+// groups and subgroups. Emitting from it gives the same source as parsing the header again.
+//
+// Layout (native byte order, every field is a u32 unless noted):
+//   header     magic "GDCGIR\0\0" (8 bytes), version, byte order mark, source path, class count,
+//              export count, group count, string count, string table size
+//   classes    name, generate, first export, export count, first group, group count,
+//              first subgroup, subgroup count
+//   exports    the export tables of all classes, stored as columns: names, types, callbacks, hints,
+//              group indices, subgroup indices (s32), then notify, flags and export types (u8 each),
+//              padded to a multiple of 4 bytes
+//   groups     name, prefix (groups and subgroups share one table)
+//   strings    the file's interned strings in id order, each NUL terminated. Names, paths and types above are ids
+//
+// Files from another version or byte order are rejected, so stale caches are regenerated, never misread.
+#define IR_VERSION 4
+#define IR_EXTENSION ".ir"
+
+// Serializes classes (with resolved exports) into out. source_path is the header the classes came from.
+// strings is the table the classes' ids refer to. Class and group names are added to it
+void ir_write(output_buffer_t* out, const char* source_path, string_table_t* strings, const class_t* classes, int class_count);
+
+// Reads classes back from an IR image into symbols, which is initialized first. Strings point into data,
+// so it must outlive the classes. Class arrays are allocated from arena. Returns false if the image is
+// invalid or from another version.
+b8 ir_read(const char* data, size_t size, arena_t* arena, class_symbols_t* symbols, const char** out_source_path, class_t** out_classes, int* out_class_count);
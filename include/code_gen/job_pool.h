@@ -0,0 +1,15 @@
+#pragma once
+
+#include "code_gen/defines.h"
+
+// Runs a single job. Returns false if the job failed.
+typedef b8 (*job_func_t)(void* user_data, int worker_index, int job_index);
+
+// Runs job_count jobs across worker_count threads (the calling thread is worker 0).
+// Jobs are dealt round-robin in index order to per-worker queues, so callers should sort
+// the most expensive jobs first. Idle workers steal from the back of other workers' queues.
+// Returns the number of jobs that failed.
+int job_pool_run(int worker_count, int job_count, job_func_t func, void* user_data);
+
+// Returns the number of online processors, or 1 if it cannot be determined.
+int job_pool_default_worker_count(void);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "code_gen/defines.h"
+
+// Splits a header into tokens in a single pass. Each token is found by a table driven DFA over character classes,
+// so every byte is looked at once. Comments, string and character literals and preprocessor directives are
+// returned as whole tokens, which keeps braces, quotes and markers inside them from being mistaken for code.
+
+typedef enum token_kind {
+    TOKEN_END,         // No more input
+    TOKEN_IDENTIFIER,  // Names and keywords
+    TOKEN_MARKER,      // One of the GD_* markers, see token_marker_t
+    TOKEN_NUMBER,
+    TOKEN_STRING,      // String or character literal including its quotes
+    TOKEN_PUNCTUATION, // A single character, i.e. '{' or ','. "::" is two tokens
+    TOKEN_COMMENT,     // Line or block comment
+    TOKEN_DIRECTIVE,   // Preprocessor line including continuations
+} token_kind_t;
+
+typedef enum token_marker {
+    TOKEN_MARKER_NONE,
+    TOKEN_MARKER_EXPORT,                 // GD_EXPORT
+    TOKEN_MARKER_EXPORT_NOTIFY,          // GD_EXPORT_NOTIFY
+    TOKEN_MARKER_EXPORT_NOTIFY_DEFERRED, // GD_EXPORT_NOTIFY_DEFERRED
+    TOKEN_MARKER_EXPORT_PACKED,          // GD_EXPORT_PACKED
+    TOKEN_MARKER_GROUP,                  // GD_GROUP
+    TOKEN_MARKER_SUBGROUP,               // GD_SUBGROUP
+} token_marker_t;
+
+typedef struct token {
+    token_kind_t kind;
+    token_marker_t marker;
+    long start; // Offset into the text
+    long length;
+} token_t;
+
+// Text is a view and does not need to be NUL terminated. It must outlive the lexer
+typedef struct lexer {
+    const char* text;
+    long length;
+    long position;
+} lexer_t;
+
+void lexer_init(lexer_t* lexer, const char* text, long length);
+
+// Reads the next token, skipping whitespace. Returns false (with a TOKEN_END token) at the end of the text
+b8 lexer_next(lexer_t* lexer, token_t* out_token);
+
+// Reads the next token that isn't a comment or directive
+b8 lexer_next_code(lexer_t* lexer, token_t* out_token);
+
+// Reads the next code token like lexer_next_code, but may skip identifiers, numbers and punctuation on the way.
+// Braces, ';' and identifiers starting with "cl", "en", "GD" or "_b" are never skipped, so a parser that only
+// looks for those can skim method bodies and declarations a block at a time (see scanner_find_candidate)
+b8 lexer_skim(lexer_t* lexer, token_t* out_token);
+
+// Returns true if the token is the punctuation character c
+b8 token_is(const lexer_t* lexer, const token_t* token, char c);
+
+// Returns true if the token's text is exactly string
+b8 token_equals(const lexer_t* lexer, const token_t* token, const char* string, long length);
@@ -1,3 +1,10 @@
+#pragma once
+
+#include "code_gen/defines.h"
+#include "code_gen/output_buffer.h"
+
+#include <stdlib.h>
+
 enum log_level {
     LOG_LEVEL_DEBUG,
     LOG_LEVEL_TRACE,
@@ -7,18 +14,48 @@ enum log_level {
     LOG_LEVEL_FATAL,
 };
 
-const char* level_strings[6] = {
-    "\x1B[32m[DEBUG]: ",
-    "\x1B[36m[TRACE]: ",
-    "\x1B[37m[INFO]:  ",
-    "\x1B[33m[WARN]:  ",
-    "\x1B[91m[ERROR]: ",
-    "\x1B[31m[FATAL]: ",
-};
+// Messages below this level are compiled out entirely, arguments included.
+// i.e. -DLOG_MIN_LEVEL=LOG_LEVEL_INFO for release builds
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// Messages below the runtime level are skipped before formatting. Defaults to LOG_LEVEL_INFO
+void log_set_level(enum log_level level);
+b8 log_level_enabled(enum log_level level);
+
+// Parses a level name (debug, trace, info, warn, error, fatal)
+b8 log_parse_level(const char* name, enum log_level* out_level);
+
+// Messages are formatted into a buffer per thread. Debug and trace messages are written once the buffer fills,
+// everything else is written immediately along with anything buffered before it.
+// Colors are only used when stdout is a terminal.
+void log_write(enum log_level level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+// Messages of the calling thread that are captured instead of written, for embedders that must not print.
+// Warnings and errors are appended compiler style, i.e. "src/player.h: error: ...", everything below is dropped
+typedef struct log_capture {
+    output_buffer_t* messages; // Optional, captured messages are dropped without it
+    const char* path;          // Optional, prefixes every message
+    int error_count;
+    int warning_count;
+} log_capture_t;
+
+// Captures the calling thread's messages until it's set back to NULL. Fatal messages are still written since they abort
+void log_set_capture(log_capture_t* capture);
+
+// Writes the calling thread's buffered messages. Threads must flush before exiting, the main thread is flushed at exit
+void log_flush(void);
+
+#define log_message(level, ...) do { \
+    if ((level) >= LOG_MIN_LEVEL && log_level_enabled(level)) { \
+        log_write(level, __VA_ARGS__); \
+    } \
+} while (0)
 
-#define log_debug(...) printf("%s", level_strings[LOG_LEVEL_DEBUG]); printf(__VA_ARGS__); printf("\x1B[0m\n");
-#define log_trace(...) printf("%s", level_strings[LOG_LEVEL_TRACE]); printf(__VA_ARGS__); printf("\x1B[0m\n");
-#define log_info(...)  printf("%s", level_strings[LOG_LEVEL_INFO]); printf(__VA_ARGS__); printf("\x1B[0m\n");
-#define log_warn(...)  printf("%s", level_strings[LOG_LEVEL_WARN]); printf(__VA_ARGS__); printf("\x1B[0m\n");
-#define log_error(...) printf("%s", level_strings[LOG_LEVEL_ERROR]); printf(__VA_ARGS__); printf("\x1B[0m\n");
-#define log_fatal(...) printf("%s", level_strings[LOG_LEVEL_FATAL]); printf(__VA_ARGS__); printf("\x1B[0m\n"); fflush(stdout); abort();
+#define log_debug(...) log_message(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define log_trace(...) log_message(LOG_LEVEL_TRACE, __VA_ARGS__)
+#define log_info(...)  log_message(LOG_LEVEL_INFO, __VA_ARGS__)
+#define log_warn(...)  log_message(LOG_LEVEL_WARN, __VA_ARGS__)
+#define log_error(...) log_message(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define log_fatal(...) do { log_write(LOG_LEVEL_FATAL, __VA_ARGS__); abort(); } while (0)
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "code_gen/defines.h"
+
+#include <stddef.h>
+
+// Growable buffer that generated sources are rendered into before being written with a single call.
+// The memory is kept when reset so one buffer can be reused for every file a generator processes.
+typedef struct output_buffer {
+    char* data;
+    size_t size;
+    size_t capacity;
+} output_buffer_t;
+
+void output_buffer_init(output_buffer_t* buffer);
+void output_buffer_free(output_buffer_t* buffer);
+void output_buffer_reset(output_buffer_t* buffer);
+
+void output_append(output_buffer_t* buffer, const char* data, size_t size);
+void output_append_string(output_buffer_t* buffer, const char* string);
+
+// Appends a string literal without measuring it at runtime
+#define output_append_literal(buffer, literal) output_append(buffer, literal, sizeof(literal) - 1)
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "code_gen/defines.h"
+
+typedef struct scan_options {
+    const char* root_path;      // Directory searched recursively for headers
+    const char* output_path;    // Generated sources mirror the header layout under this directory
+    const char* list_path;      // Optional. Receives the generated source paths, one per line
+    const char** filters;       // Glob patterns matched against file names. Defaults to *.h and *.hpp
+    int filter_count;
+    int worker_count;
+
+    // Amalgamates the generated code of several headers into unity_<n>.cpp sources.
+    // Groups are closed after unity_count headers or once they hold unity_bytes of generated code.
+    // Both 0 writes one source per header
+    int unity_count;
+    long unity_bytes;
+
+    b8 write_ir; // Writes each header's IR next to its (per header) output path
+    b8 write_depfile; // Writes a depfile next to every generated source
+    b8 write_inline; // Writes accessors to an inline companion next to each header's (per header) output path
+    b8 property_table; // Registers properties from a constant table in _bind_methods
+} scan_options_t;
+
+// Generates sources for every matching header below root_path. Headers that can't contain exports
+// (no GD_EXPORT or _bind_methods anywhere in the file) are skipped and produce no output.
+// In unity mode headers are grouped in path order, so a group only changes when one of its headers does
+// or when headers before it are added or removed.
+// Returns 0 if every header was generated.
+int scan_run(const scan_options_t* options);
@@ -0,0 +1,15 @@
+#pragma once
+
+// Block searches over header text for the lexer. Each returns the first offset at or after start that the search
+// stops at, or length if there is none. Uses AVX2 or SSE2 when available with a scalar fallback.
+
+// Stops at any of the three bytes. Pass a byte more than once to look for fewer
+long scanner_find_any(const char* text, long start, long length, char a, char b, char c);
+
+// Stops at the first byte that isn't whitespace (' ', '\t', '\n', '\v', '\f' or '\r')
+long scanner_skip_space(const char* text, long start, long length);
+
+// Stops at a byte that can begin something the header parser cares about outside a marker or class head:
+// a brace, ';', the start of a comment, literal or directive ('/', '"', '\'' and '#'), or "cl" (class),
+// "en" (enum), "GD" (markers) and "_b" (_bind_methods). Pairs can also be found inside longer identifiers
+long scanner_find_candidate(const char* text, long start, long length);
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "code_gen/defines.h"
+
+// Environment variable checked for a server socket when --socket isn't passed
+#define SERVER_SOCKET_ENV "SOURCE_GEN_SOCKET"
+
+// Listens on a Unix domain socket and generates files for clients until interrupted.
+// Rendered output is cached by input path and content hash, so unchanged headers are never reparsed.
+int server_run(const char* socket_path);
+
+// Asks the server at socket_path to generate output_path from input_path.
+// Returns false if no server could be reached, in which case the caller should generate in-process.
+// Otherwise out_success holds whether the server generated the file, and the header's diagnostics have been printed.
+b8 server_request(const char* socket_path, const char* input_path, const char* output_path, b8* out_success);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "code_gen/arena.h"
+#include "code_gen/defines.h"
+#include "code_gen/output_buffer.h"
+
+#include <stddef.h>
+
+// Interns the strings of one file. Equal strings share an id, so they are stored once and compared by id.
+// Ids are dense and start at 0, which is always the empty string, so per string data can live in plain arrays.
+// Everything is allocated from the arena, the table is dropped with it and initialized again for the next file.
+typedef u32 string_id_t;
+
+#define STRING_ID_EMPTY 0
+
+typedef struct string_entry {
+    const char* text; // NUL terminated
+    u32 length;
+    u32 hash;
+} string_entry_t;
+
+typedef struct string_table {
+    arena_t* arena;
+    string_entry_t* entries; // Indexed by id
+    u32 count;
+    u32 capacity;
+    u32* slots; // Open addressing, holds id + 1 so 0 is an empty slot
+    u32 slot_mask;
+} string_table_t;
+
+void string_table_init(string_table_t* table, arena_t* arena);
+
+// Returns the id of text, copying it into the arena the first time it is seen
+string_id_t string_table_intern(string_table_t* table, const char* text, size_t length);
+
+static inline const char* string_table_get(const string_table_t* table, string_id_t id) {
+    return table->entries[id].text;
+}
+
+// Appends every string in id order, each followed by a NUL
+void string_table_write(const string_table_t* table, output_buffer_t* out);
+
+// Adds count NUL terminated strings from data in order, so they get the ids they were written with.
+// Strings point into data, which must outlive the table. Returns false if data doesn't hold exactly count strings
+// or doesn't start with the empty string
+b8 string_table_load(string_table_t* table, const char* data, size_t size, u32 count);
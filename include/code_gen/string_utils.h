@@ -1,7 +1,9 @@
 #pragma once
 
 #include "code_gen/defines.h"
-#include <stdio.h>
+#include <stddef.h>
 
 b8 char_valid_in_name(char c);
-void write_text(const char* text, FILE* file);
+
+// 64 bit FNV-1a hash
+u64 hash_bytes(const void* data, size_t size);
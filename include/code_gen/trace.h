@@ -0,0 +1,56 @@
+#pragma once
+
+#include "code_gen/defines.h"
+
+// Records timed spans and counters for a run and writes them as Chrome trace event JSON
+// (chrome://tracing, ui.perfetto.dev). Spans are recorded per thread so workers never contend,
+// counters are shared and sampled after every generated file.
+// Tracing is off unless trace_start is called, in which case every call below is a single branch.
+
+typedef enum trace_span_kind {
+    TRACE_SPAN_FILE,      // One header or IR file, read to write
+    TRACE_SPAN_READ,      // Mapping the input
+    TRACE_SPAN_PREFILTER, // Quick check for anything to generate
+    TRACE_SPAN_PARSE,     // Scanning and parsing the whole header
+    TRACE_SPAN_CLASS,     // One class, from its name to its closing brace
+    TRACE_SPAN_RESOLVE,   // Resolving the export types of one class
+    TRACE_SPAN_EMIT,      // Rendering the generated source
+    TRACE_SPAN_WRITE,     // Writing (or comparing) one output file
+    TRACE_SPAN_KIND_COUNT,
+} trace_span_kind_t;
+
+typedef enum trace_counter {
+    TRACE_COUNTER_FILES,
+    TRACE_COUNTER_LINES,       // Statements found while parsing
+    TRACE_COUNTER_CLASSES,
+    TRACE_COUNTER_EXPORTS,
+    TRACE_COUNTER_GROUPS,      // Groups and subgroups
+    TRACE_COUNTER_BYTES_IN,
+    TRACE_COUNTER_BYTES_OUT,
+    TRACE_COUNTER_ALLOCATIONS, // Arena blocks and buffer growth
+    TRACE_COUNTER_COUNT,
+} trace_counter_t;
+
+typedef struct trace_span {
+    trace_span_kind_t kind;
+    u64 start; // Nanoseconds, 0 if tracing was off when the span began
+} trace_span_t;
+
+// Starts recording. Must be called before any worker threads are started.
+b8 trace_start(const char* path);
+
+// Writes everything recorded to the path given to trace_start and stops recording.
+// Must be called after all worker threads have finished.
+b8 trace_stop(void);
+
+b8 trace_active(void);
+
+trace_span_t trace_begin(trace_span_kind_t kind);
+
+// detail (optional) is shown with the span, i.e. the file path or class name
+void trace_end(trace_span_t span, const char* detail);
+
+void trace_count(trace_counter_t counter, u64 value);
+
+// Adds a sample of every counter to the timeline
+void trace_sample_counters(void);
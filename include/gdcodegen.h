@@ -0,0 +1,59 @@
+#pragma once
+
+// libgdcodegen, the property code generator as a library. Headers are read from and generated sources are
+// returned in memory, so editors, build plugins and test harnesses can generate without spawning source_gen or
+// touching the filesystem. Only plain C types are used so the header can be included from C and C++.
+//
+// gdcg_generate is reentrant, every call works on its own state and any number of threads may generate at once.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define GDCG_API __attribute__((visibility("default")))
+#else
+#define GDCG_API
+#endif
+
+typedef struct gdcg_options {
+    // Path of the header as the generated source should include it, i.e. "src/player.h". Also used in diagnostics
+    const char* source_path;
+    // Register properties from a constant table in _bind_methods (see --property-table)
+    int property_table;
+    // Emit getters and setters to inline_source instead of the generated source (see --inline)
+    int inline_accessors;
+} gdcg_options;
+
+// Every buffer is NUL terminated, allocated by the library and released with gdcg_output_free.
+// Sizes don't count the NUL
+typedef struct gdcg_output {
+    char* source;        // NULL if the header has errors
+    size_t source_size;
+    char* inline_source; // Only set with inline_accessors
+    size_t inline_size;
+
+    // Compiler style errors and warnings, one per line, i.e. "src/player.h:12:15: error: ...". NULL if there are none
+    char* diagnostics;
+    size_t diagnostics_size;
+    int error_count;
+    int warning_count;
+} gdcg_output;
+
+// Generates the source for the header in src, which doesn't need to be NUL terminated. options may be NULL
+// when the header has no path, it is then included as "source.h". out is always filled and must be freed.
+// Returns 0 on success, or -1 if the header has errors or the arguments are invalid
+GDCG_API int gdcg_generate(const char* src, size_t len, const gdcg_options* options, gdcg_output* out);
+
+GDCG_API void gdcg_output_free(gdcg_output* out);
+
+// Makes alias resolve to the same export type as target, i.e. ("real_t", "float"). Applies to every later
+// gdcg_generate in the process. Not thread safe, register aliases before generating.
+// Returns 0 on success, or -1 if target is unknown or alias already names a different type
+GDCG_API int gdcg_register_alias(const char* alias, const char* target);
+
+#ifdef __cplusplus
+}
+#endif
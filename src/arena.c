@@ -0,0 +1,120 @@
+#include "code_gen/arena.h"
+#include "code_gen/logging.h"
+#include "code_gen/trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Private structs
+struct arena_block {
+    arena_block_t* next;
+    size_t capacity;
+    size_t used;
+    size_t last_offset; // Start of the most recent allocation, so it can be grown in place
+    _Alignas(16) char data[];
+};
+
+// Private data
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGNMENT 16
+
+// Private functions
+static arena_block_t* create_block(size_t capacity);
+
+// Function Impls
+void arena_init(arena_t* arena) {
+    memset(arena, 0, sizeof(arena_t));
+}
+
+void arena_free(arena_t* arena) {
+    arena_block_t* block = arena->first;
+    while (block) {
+        arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+
+    memset(arena, 0, sizeof(arena_t));
+}
+
+void arena_reset(arena_t* arena) {
+    if (!arena->first) {
+        return;
+    }
+
+    // Only the first block is kept so one unusually large file doesn't pin its memory
+    arena_block_t* block = arena->first->next;
+    while (block) {
+        arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+
+    arena->first->next = NULL;
+    arena->first->used = 0;
+    arena->first->last_offset = 0;
+    arena->current = arena->first;
+}
+
+void* arena_alloc(arena_t* arena, size_t size) {
+    size_t aligned_size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+    arena_block_t* block = arena->current;
+    if (!block || block->capacity - block->used < aligned_size) {
+        // Oversized allocations get a block of their own
+        arena_block_t* new_block = create_block(aligned_size > ARENA_BLOCK_SIZE ? aligned_size : ARENA_BLOCK_SIZE);
+        if (block) {
+            block->next = new_block;
+        } else {
+            arena->first = new_block;
+        }
+        arena->current = new_block;
+        block = new_block;
+    }
+
+    block->last_offset = block->used;
+    block->used += aligned_size;
+    return block->data + block->last_offset;
+}
+
+void* arena_grow(arena_t* arena, void* data, size_t old_size, size_t new_size) {
+    if (new_size <= old_size) {
+        return data;
+    }
+
+    size_t aligned_size = (new_size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    arena_block_t* block = arena->current;
+    if (data && block && data == block->data + block->last_offset &&
+            block->capacity - block->last_offset >= aligned_size) {
+        block->used = block->last_offset + aligned_size;
+        return data;
+    }
+
+    void* new_data = arena_alloc(arena, new_size);
+    if (data) {
+        memcpy(new_data, data, old_size);
+    }
+    return new_data;
+}
+
+char* arena_copy_string(arena_t* arena, const char* text, size_t length) {
+    char* string = arena_alloc(arena, length + 1);
+    memcpy(string, text, length);
+    string[length] = 0;
+    return string;
+}
+
+// Private functions
+static arena_block_t* create_block(size_t capacity) {
+    arena_block_t* block = malloc(sizeof(arena_block_t) + capacity);
+    if (!block) {
+        log_fatal("Failed to allocate %zu byte arena block.", capacity);
+    }
+    trace_count(TRACE_COUNTER_ALLOCATIONS, 1);
+
+    block->next = NULL;
+    block->capacity = capacity;
+    block->used = 0;
+    block->last_offset = 0;
+    return block;
+}
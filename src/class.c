@@ -1,5 +1,6 @@
 #include "code_gen/class_parser.h"
-#include "code_gen/string_utils.h"
+#include "code_gen/diagnostics.h"
+#include "code_gen/export_types.h"
 #include "code_gen/logging.h"
 
 #include <stdio.h>
@@ -8,348 +9,565 @@
 
 
 // Private data
-#define EXPORT_TAG "GD_EXPORT"
-#define EXPORT_TAG_SIZE sizeof(EXPORT_TAG)
-
-#define GROUP_TAG "GD_GROUP"
-#define GROUP_TAG_SIZE sizeof(GROUP_TAG)
-
-#define SUBGROUP_TAG "GD_SUBGROUP"
-#define SUBGROUP_TAG_SIZE sizeof(SUBGROUP_TAG)
+// Markers take at most this many arguments (GD_EXPORT_NOTIFY's type, name and callback)
+#define MARKER_ARGUMENT_MAX 3
+
+// Godot's values of Variant::OBJECT and PROPERTY_HINT_RESOURCE_TYPE, baked into typed array hints in table mode.
+// The generated code static_asserts them
+#define VARIANT_OBJECT_VALUE "24"
+#define PROPERTY_HINT_RESOURCE_TYPE_VALUE "17"
+
+// Emitted once per translation unit (unity sources hold several) before the first table driven _bind_methods
+static const char property_table_preamble[] =
+    "#ifndef GDCG_PROPERTY_TABLE\n"
+    "#define GDCG_PROPERTY_TABLE\n"
+    "namespace {\n"
+    "\tstatic_assert(Variant::OBJECT == " VARIANT_OBJECT_VALUE " && PROPERTY_HINT_RESOURCE_TYPE == " PROPERTY_HINT_RESOURCE_TYPE_VALUE ", \"Precomputed typed array hints don't match this Godot version\");\n"
+    "\n"
+    "\tenum gdcg_entry_kind : unsigned char { GDCG_PROPERTY, GDCG_GROUP, GDCG_SUBGROUP };\n"
+    "\n"
+    "\t// One ADD_PROPERTY, ADD_GROUP or ADD_SUBGROUP. Groups keep their prefix in hint_string\n"
+    "\tstruct gdcg_property {\n"
+    "\t\tgdcg_entry_kind kind;\n"
+    "\t\tVariant::Type type;\n"
+    "\t\tPropertyHint hint;\n"
+    "\t\tconst char* name;\n"
+    "\t\tconst char* hint_string;\n"
+    "\t\tconst char* setter;\n"
+    "\t\tconst char* getter;\n"
+    "\t};\n"
+    "\n"
+    "\t[[maybe_unused]] void gdcg_register_properties(const StringName& class_name, const gdcg_property* properties, size_t count) {\n"
+    "\t\tfor (size_t i = 0; i < count; i++) {\n"
+    "\t\t\tconst gdcg_property& property = properties[i];\n"
+    "\t\t\tswitch (property.kind) {\n"
+    "\t\t\t\tcase GDCG_GROUP:\n"
+    "\t\t\t\t\tClassDB::add_property_group(class_name, property.name, property.hint_string);\n"
+    "\t\t\t\t\tbreak;\n"
+    "\t\t\t\tcase GDCG_SUBGROUP:\n"
+    "\t\t\t\t\tClassDB::add_property_subgroup(class_name, property.name, property.hint_string);\n"
+    "\t\t\t\t\tbreak;\n"
+    "\t\t\t\tcase GDCG_PROPERTY:\n"
+    "\t\t\t\t\tClassDB::add_property(class_name, PropertyInfo(property.type, property.name, property.hint, property.hint_string), property.setter, property.getter);\n"
+    "\t\t\t\t\tbreak;\n"
+    "\t\t\t}\n"
+    "\t\t}\n"
+    "\t}\n"
+    "}\n"
+    "#endif\n";
 
 // Private structs
+// How an export is shown in the editor
+typedef struct property_desc {
+    const char* variant_string; // Variant::Type without the prefix, i.e. "FLOAT"
+    const char* hint;           // PropertyHint, or NULL for none. The export's hint is the hint string
+    b8 typed_array;             // The hint string is the element type of a typed array
+} property_desc_t;
+
+// One export with its strings looked up, gathered from the export table while it is emitted
+typedef struct export_view {
+    const char* name;
+    const char* type;
+    const char* hint;
+    const char* notify_callback; // NULL without notify
+    export_type_t export_type;
+    export_notify_t notify;
+    u8 flags;
+} export_view_t;
+
+// One argument of a marker, from the start of its first token to the end of its last
+typedef struct marker_argument {
+    token_t first;
+    long end;
+    int token_count;
+} marker_argument_t;
 
 // Private functions
-void add_property(export_t* export, export_type_t type, const char* type_str, FILE* file);
-void write_impl(class_t* class, const char* source_file, FILE* file);
-void parse_group(const char* line, char** out_name, char** out_prefix);
+b8 normalize_type(class_symbols_t* symbols, string_id_t raw_type, long offset, diagnostics_t* diagnostics, type_info_t* out_info);
+void get_export(const class_t* class, int index, export_view_t* out_export);
+b8 describe_property(export_type_t export_type, property_desc_t* out_desc);
+void write_bind_methods(output_buffer_t* out, const class_t* class, const export_view_t* export);
+void write_property(output_buffer_t* out, const export_view_t* export, const property_desc_t* desc);
+void write_property_table(output_buffer_t* out, const class_t* class, const property_desc_t* descs);
+void write_table_group(output_buffer_t* out, const char* kind, const group_t* group);
+void write_group(output_buffer_t* out, const char* macro_start, const group_t* group);
+void write_accessor_functions(output_buffer_t* out, const class_t* class, const char* specifier);
+void write_notify_setter_body(output_buffer_t* out, const class_t* class, const export_view_t* export, const char* specifier);
+void write_packed_accessors(output_buffer_t* out, const class_t* class, const export_view_t* export, const char* specifier);
+b8 read_marker_arguments(lexer_t* lexer, const token_t* marker, diagnostics_t* diagnostics, marker_argument_t* arguments, int* out_count);
+b8 parse_export(class_t* class, const lexer_t* lexer, const token_t* marker, diagnostics_t* diagnostics, const marker_argument_t* arguments, int argument_count);
+void parse_group(class_t* class, const lexer_t* lexer, group_t* group, const marker_argument_t* arguments, int argument_count);
+const char* copy_argument(class_t* class, const lexer_t* lexer, const marker_argument_t* argument);
+string_id_t intern_argument(class_t* class, const lexer_t* lexer, const marker_argument_t* argument);
+void* reserve_element(arena_t* arena, void* data, int count, int* capacity, size_t element_size);
 
 // Function Impls
-void class_parse_line(class_t* class, const char* line) {
-    // Ignore comments
-    if (strcmp(line, "//") == 0) {
-        return;
-    }
-        log_debug("Parsing line: '%s'", line);
+void class_symbols_init(class_symbols_t* symbols, arena_t* arena) {
+    string_table_init(&symbols->strings, arena);
+    symbols->types = NULL;
+    symbols->type_capacity = 0;
+}
 
-    // Get groups
-    if (strncmp(line, GROUP_TAG, GROUP_TAG_SIZE - 1) == 0) {
-        group_t* group = &class->groups[class->group_count++];
-        group->start_export_index = class->export_count;
-        parse_group(line, (char**)&group->name, (char**)&group->prefix);
+void class_reset(class_t* class, arena_t* arena, class_symbols_t* symbols) {
+    memset(class, 0, sizeof(class_t));
+    class->arena = arena;
+    class->symbols = symbols;
+    class->name = "";
+}
 
-        log_debug("Found group. Name: '%s'; Prefix, '%s'", group->name, group->prefix);
+void class_reserve_exports(class_t* class, int count) {
+    export_table_t* exports = &class->exports;
+    if (count <= exports->capacity) {
+        return;
     }
-    if (strncmp(line, SUBGROUP_TAG, SUBGROUP_TAG_SIZE - 1) == 0) {
-        group_t* group = &class->subgroups[class->subgroup_count++];
-        group->start_export_index = class->export_count;
-        parse_group(line, (char**)&group->name, (char**)&group->prefix);
 
-        log_debug("Found sub group. Name: '%s'; Prefix, '%s'", group->name, group->prefix);
+    int capacity = exports->capacity ? exports->capacity : 16;
+    while (capacity < count) {
+        capacity *= 2;
     }
 
-    // Get line length
-    int line_length = strlen(line);
-    const int line_start = EXPORT_TAG_SIZE; // Data starts after the tag
-
-    // Check for bind methods
-    for (int i = line_start; i < line_length; i++) {
-        const char c = line[i];
-        if (c != '_') {
-            continue;
-        }
+    arena_t* arena = class->arena;
+    const size_t old_count = exports->capacity;
+    exports->names = arena_grow(arena, exports->names, sizeof(string_id_t) * old_count, sizeof(string_id_t) * capacity);
+    exports->types = arena_grow(arena, exports->types, sizeof(string_id_t) * old_count, sizeof(string_id_t) * capacity);
+    exports->callbacks = arena_grow(arena, exports->callbacks, sizeof(string_id_t) * old_count, sizeof(string_id_t) * capacity);
+    exports->notify = arena_grow(arena, exports->notify, old_count, capacity);
+    exports->flags = arena_grow(arena, exports->flags, old_count, capacity);
+    exports->groups = arena_grow(arena, exports->groups, sizeof(int) * old_count, sizeof(int) * capacity);
+    exports->subgroups = arena_grow(arena, exports->subgroups, sizeof(int) * old_count, sizeof(int) * capacity);
+    exports->export_types = arena_grow(arena, exports->export_types, old_count, capacity);
+    exports->hints = arena_grow(arena, exports->hints, sizeof(string_id_t) * old_count, sizeof(string_id_t) * capacity);
+    exports->offsets = arena_grow(arena, exports->offsets, sizeof(long) * old_count, sizeof(long) * capacity);
+    exports->capacity = capacity;
+}
 
-        if (strncmp(line + i, "_bind_methods", sizeof("_bind_methods") - 1) == 0) {
-            class->generate = 1;
-            break;
-        }
+b8 class_parse_marker(class_t* class, lexer_t* lexer, const token_t* marker, diagnostics_t* diagnostics) {
+    marker_argument_t arguments[MARKER_ARGUMENT_MAX];
+    int argument_count = 0;
+    if (!read_marker_arguments(lexer, marker, diagnostics, arguments, &argument_count)) {
+        return false;
     }
 
-    // Check if the line is an export
-    if (strncmp(line, EXPORT_TAG, EXPORT_TAG_SIZE - 1) != 0) {
-        return;
+    switch (marker->marker) {
+        case TOKEN_MARKER_GROUP:
+            class->groups = reserve_element(class->arena, class->groups, class->group_count, &class->group_capacity, sizeof(group_t));
+            parse_group(class, lexer, &class->groups[class->group_count++], arguments, argument_count);
+            log_debug("Found group. Name: '%s'; Prefix, '%s'", class->groups[class->group_count - 1].name, class->groups[class->group_count - 1].prefix);
+            return true;
+        case TOKEN_MARKER_SUBGROUP:
+            class->subgroups = reserve_element(class->arena, class->subgroups, class->subgroup_count, &class->subgroup_capacity, sizeof(group_t));
+            parse_group(class, lexer, &class->subgroups[class->subgroup_count++], arguments, argument_count);
+            log_debug("Found sub group. Name: '%s'; Prefix, '%s'", class->subgroups[class->subgroup_count - 1].name, class->subgroups[class->subgroup_count - 1].prefix);
+            return true;
+        default:
+            return parse_export(class, lexer, marker, diagnostics, arguments, argument_count);
     }
+}
 
-    // Parse out the type
-    char type[2048] = {}; // Temporary buffer that can be modified
-    for (int i = line_start; i < line_length; i++) {
-        const char c = line[i];
+b8 class_resolve_exports(class_t* class, diagnostics_t* diagnostics) {
+    class_symbols_t* symbols = class->symbols;
+    export_table_t* exports = &class->exports;
 
-        // Searches until the comment in the export tag
-        // GD_EXPORT(float, time) = 0;
-        //                ^ looks for this since 'GD_EXPORT(' is trimmed
-        if (c == ',') {
-            memcpy(type, line + line_start, i - line_start);
-            break;
+    // Ids of types seen before this class are already resolved, new ones are resolved the first time they're used
+    const u32 string_count = symbols->strings.count;
+    if (string_count > symbols->type_capacity) {
+        u32 capacity = symbols->type_capacity ? symbols->type_capacity : 64;
+        while (capacity < string_count) {
+            capacity *= 2;
         }
+        symbols->types = arena_grow(class->arena, symbols->types, sizeof(type_info_t) * symbols->type_capacity, sizeof(type_info_t) * capacity);
+        memset(symbols->types + symbols->type_capacity, 0, sizeof(type_info_t) * (capacity - symbols->type_capacity));
+        symbols->type_capacity = capacity;
     }
 
-    // Parese out the name
-    b8 found_name_start = false;
-    char name[2048] = {};
-    for (int i = line_start, name_start = 0; i < line_length; i++) {
-        char c = line[i];
-
-        // Finds the start if the name
-        if (c == ',') {
-            found_name_start = true;
-            // Read forward until a character that cannot be in a variable name is found
-            while (!char_valid_in_name(c)) {
-                c = line[i++];
-            }
-
-            // Decrement since c will be an invalid character
-            i--;
-            name_start = i;
+    // Every export is checked so all bad types in a class are reported at once
+    b8 success = true;
+    for (int i = 0; i < exports->count; i++) {
+        type_info_t* info = &symbols->types[exports->types[i]];
+        if (info->export_type == EXPORT_TYPE_NULL && !normalize_type(symbols, exports->types[i], exports->offsets[i], diagnostics, info)) {
+            success = false;
             continue;
         }
 
-        // Search until the end of name is found
-        if (!char_valid_in_name(c) && found_name_start) {
-            int name_length = i - name_start;
-            memcpy(name, line + name_start, name_length);
-            name[name_length + 1] = 0;
-            break;
+        if ((exports->flags[i] & EXPORT_FLAG_PACKED_ACCESSORS) && !export_types_packed_element(info->export_type)) {
+            diagnostics_error(diagnostics, exports->offsets[i], "GD_EXPORT_PACKED needs a Packed*Array type, '%s' is not one (export '%s').",
+                    string_table_get(&symbols->strings, exports->types[i]), string_table_get(&symbols->strings, exports->names[i]));
+            success = false;
+            continue;
         }
-    }
 
-    // Ensure that both a name and type were found
-    if (strcmp(name, "") == 0 || strcmp(type, "") == 0) {
-        log_fatal("Failed to get export data (Name: '%s', Type: '%s'. Line: '%s'", name, type, line);
+        exports->export_types[i] = info->export_type;
+        exports->hints[i] = info->hint;
+        exports->flags[i] = (exports->flags[i] & ~EXPORT_TYPE_FLAGS) | info->flags;
     }
 
-    // Create a new export and copy data
-    export_t export = {};
-    strcpy(export.name, name);
-    strcpy(export.type, type);
-
-    // Add exports to the class
-    if (class->export_count >= MAX_CLASS_EXPORTS) {
-        log_fatal("Cannot have more than %d exports in a class.", MAX_CLASS_EXPORTS);
-    }
-    class->exports[class->export_count++] = export;
+    return success;
 }
 
-
-void class_write_exports(class_t* class, const char* source_path, FILE* file) {
+b8 class_write_exports(const class_t* class, const char* source_path, const emit_options_t* options, output_buffer_t* out) {
     // Don't write anything if there's no data to generate
     // This prevents _bind_methods() from being generated in classes it shouldn't be
-    if (class->export_count <= 0 && !class->generate) {
-        write_text("// No data found for class", file);
-        return;
+    if (class->exports.count <= 0 && !class->generate) {
+        output_append_literal(out, "// No data found for class");
+        return true;
     }
 
     // Add includes
-    char buffer[2048] = {};
-    snprintf(buffer, sizeof(buffer), "#include \"%s\"\nusing namespace godot;\n", source_path);
-    write_text(buffer, file);
+    output_append_literal(out, "#include \"");
+    output_append_string(out, source_path);
+    output_append_literal(out, "\"\nusing namespace godot;\n");
+    if (options->property_table) {
+        output_append_literal(out, property_table_preamble);
+    }
 
     // Add Bind methods
-    write_text("namespace wander {\n", file);
-    snprintf(buffer, sizeof(buffer), "\n\tvoid %s::_bind_methods() {\n", class->name);
-    write_text(buffer, file);
-
-    // Write all exports
-    for (int i = 0; i < class->export_count; i++) {
-        // Write groups 
-        for (int j = 0; j < class->group_count; j++) {
-            group_t group = class->groups[j];
-            if (group.start_export_index == i) {
-                snprintf(buffer, sizeof(buffer), "\t\tADD_GROUP(\"%s\", \"%s\");\n", group.name, group.prefix);
-                write_text(buffer, file);
+    output_append_literal(out, "namespace wander {\n");
+    output_append_literal(out, "\n\tvoid ");
+    output_append_string(out, class->name);
+    output_append_literal(out, "::_bind_methods() {\n");
+
+    // Every property needs its getter and setter bound first, so a table can only follow all bind_method calls
+    if (options->property_table && class->exports.count > 0) {
+        property_desc_t* descs = malloc(sizeof(property_desc_t) * class->exports.count);
+        for (int i = 0; i < class->exports.count; i++) {
+            if (!describe_property(class->exports.export_types[i], &descs[i])) {
+                free(descs);
+                return false;
             }
+            export_view_t export;
+            get_export(class, i, &export);
+            write_bind_methods(out, class, &export);
         }
 
-        for (int j = 0; j < class->subgroup_count; j++) {
-            group_t group = class->subgroups[j];
-            if (group.start_export_index == i) {
-                snprintf(buffer, sizeof(buffer), "\t\tADD_SUBGROUP(\"%s\", \"%s\");\n", group.name, group.prefix);
-                write_text(buffer, file);
-            }
+        write_property_table(out, class, descs);
+        free(descs);
+    }
+
+    // Write all exports. Groups are written before the first export in them
+    int group = -1;
+    int subgroup = -1;
+    for (int i = 0; !options->property_table && i < class->exports.count; i++) {
+        while (group < class->exports.groups[i]) {
+            write_group(out, "\t\tADD_GROUP(\"", &class->groups[++group]);
+        }
+        while (subgroup < class->exports.subgroups[i]) {
+            write_group(out, "\t\tADD_SUBGROUP(\"", &class->subgroups[++subgroup]);
         }
 
         // Write export getter and setter reflection info
-        export_t* export = &class->exports[i];
-        snprintf(buffer, sizeof(buffer), "\t\tClassDB::bind_method(D_METHOD(\"get_%s\"), &%s::get_%s);\n", export->name, class->name, export->name);
-        write_text(buffer, file);
+        export_view_t export;
+        get_export(class, i, &export);
+        write_bind_methods(out, class, &export);
+
+        property_desc_t desc;
+        if (!describe_property(export.export_type, &desc)) {
+            return false;
+        }
+        write_property(out, &export, &desc);
+    }
 
-        snprintf(buffer, sizeof(buffer), "\t\tClassDB::bind_method(D_METHOD(\"set_%s\", \"%s\"), &%s::set_%s);\n", export->name, export->name, class->name, export->name);
-        write_text(buffer, file);
+    // Close bind methods function
+    output_append_literal(out, "\n\t}\n");
 
-        // Remove all keywords from type
-        char type[256] = {}; // New keywordless type
-        int type_offset = 0;
-        strcpy(type, export->type);
+    // Write getter and setter functions
+    if (!options->inline_accessors) {
+        write_accessor_functions(out, class, "");
+    }
 
-        for (int k = 0; k < keyword_count; k++) {
-            if (strncmp(type, keywords[k], strlen(keywords[k]) - 1) == 0) {
-                type_offset += strlen(keywords[k]) + 1;
-            }
+    // Close namespace
+    output_append_literal(out, "}\n");
+    return true;
+}
+
+void class_write_inline_accessors(const class_t* class, output_buffer_t* out) {
+    if (class->exports.count <= 0) {
+        return;
+    }
+
+    write_accessor_functions(out, class, "inline ");
+}
+
+// Private functions
+// Trims keywords, godot:: and the Ref<> and TypedArray<> wrappers from a raw type and looks up what's left
+b8 normalize_type(class_symbols_t* symbols, string_id_t raw_type, long offset, diagnostics_t* diagnostics, type_info_t* out_info) {
+    const char* raw = string_table_get(&symbols->strings, raw_type);
+
+    // Remove all keywords from type
+    char* type = arena_copy_string(symbols->strings.arena, raw, symbols->strings.entries[raw_type].length); // New keywordless type
+    int type_offset = 0;
+
+    for (int k = 0; k < keyword_count; k++) {
+        if (strncmp(type, keywords[k], strlen(keywords[k]) - 1) == 0) {
+            type_offset += strlen(keywords[k]) + 1;
         }
+    }
 
-        // Trim excess info from type and store info
-        int type_len = strlen(type);
-        b8 trimmed = false;
-        b8 is_resource = false;
-        b8 is_typed_array = false;
-        while (!trimmed) {
-            trimmed = true;
-
-            // Remove godot::
-            if (strncmp(type + type_offset, "godot::", 7) == 0) {
-                type_offset += strlen("godot::");
-                trimmed = false;
-            }
+    // Trim excess info from type and store info
+    int type_len = strlen(type);
+    b8 trimmed = false;
+    b8 is_resource = false;
+    b8 is_typed_array = false;
+    while (!trimmed) {
+        trimmed = true;
+
+        // Remove godot::
+        if (strncmp(type + type_offset, "godot::", 7) == 0) {
+            type_offset += strlen("godot::");
+            trimmed = false;
+        }
 
-            // Check for typed arrays
-            if (strncmp(type + type_offset, "TypedArray<", 11) == 0) {
-                type_offset += strlen("TypedArray<");
-                is_typed_array = true;
-                for (int j = type_len; j >= type_offset; j--) {
-                    if (type[j] == '>') {
-                        type_len = j;
-                        break;
-                    }
+        // Check for typed arrays
+        if (strncmp(type + type_offset, "TypedArray<", 11) == 0) {
+            type_offset += strlen("TypedArray<");
+            is_typed_array = true;
+            for (int j = type_len; j >= type_offset; j--) {
+                if (type[j] == '>') {
+                    type_len = j;
+                    break;
                 }
-                trimmed = false;
             }
+            trimmed = false;
+        }
 
-            // Remove Ref<> and mark as resource
-            if (strncmp(type + type_offset, "Ref<", 4) == 0) {
-                type_offset += strlen("Ref<");
-                is_resource = true;
+        // Remove Ref<> and mark as resource
+        if (strncmp(type + type_offset, "Ref<", 4) == 0) {
+            type_offset += strlen("Ref<");
+            is_resource = true;
 
-                for (int j = type_len; j >= type_offset; j--) {
-                    if (type[j] == '>') {
-                        type_len = j;
-                        break;
-                    }
+            for (int j = type_len; j >= type_offset; j--) {
+                if (type[j] == '>') {
+                    type_len = j;
+                    break;
                 }
-                trimmed = false;
             }
+            trimmed = false;
         }
+    }
 
-        // Check for nodes (Needs to be a pointer)
-        b8 is_ptr = false;
-        for (int j = 0; j < type_len; j++) {
-            if (type[j] == '*') {
-                type[j] = 0;
-                is_ptr = true;
-                break;
-            }
+    // Check for nodes (Needs to be a pointer)
+    b8 is_ptr = false;
+    for (int j = 0; j < type_len; j++) {
+        if (type[j] == '*') {
+            type[j] = 0;
+            is_ptr = true;
+            break;
         }
+    }
 
-        // Get export type from type string
-        // NOTE: Messy due to lack of string parsing in C.
-        // Also requires branches depending on data type and variant type
-        const char* _type = type + type_offset;
-        type[type_len] = 0;
-
-        export_type_t export_type = EXPORT_TYPE_NULL;
-        if (is_typed_array) {
-            if (is_resource) {
-                export_type = EXPORT_TYPE_TYPED_RESOURCE_ARRAY;
-            } else {
-                export_type = EXPORT_TYPE_TYPED_ARRAY;
-            }
-        } else if (is_resource) {
-            export_type = EXPORT_TYPE_RESOURCE;
-        } else if (is_ptr) {
-            export_type = EXPORT_TYPE_NODE;
-        } else {
-            for (int i = 0; i < export_type_alias_count; i++) {
-                const export_type_alias_t* alias = &export_type_aliases[i];
-
-                b8 found = false;
-                for (int j = 0; j < alias->alias_count; j++) {
-                    if (strcmp(_type, alias->aliases[j]) == 0) {
-                        export_type = alias->type;
-                        found = true;
-                        break;
-                    }
-                }
+    // Get export type from type string
+    // NOTE: Messy due to lack of string parsing in C.
+    // Also requires branches depending on data type and variant type
+    const char* _type = type + type_offset;
+    type[type_len] = 0;
 
-                if (found) {
-                    break;
-                }
-            }
+    export_type_t export_type = EXPORT_TYPE_NULL;
+    if (is_typed_array) {
+        if (is_resource) {
+            export_type = EXPORT_TYPE_TYPED_RESOURCE_ARRAY;
+        } else {
+            export_type = EXPORT_TYPE_TYPED_ARRAY;
         }
+    } else if (is_resource) {
+        export_type = EXPORT_TYPE_RESOURCE;
+    } else if (is_ptr) {
+        export_type = EXPORT_TYPE_NODE;
+    } else {
+        export_type = export_types_lookup(_type, strlen(_type));
+    }
 
-        if (export_type == EXPORT_TYPE_NULL) {
-            log_fatal("Unrecognized export type '%s' ('%s' / '%s')\n", type, export->type, _type);
-            abort();
+    if (export_type == EXPORT_TYPE_NULL) {
+        if (strcmp(_type, raw) == 0) {
+            diagnostics_error(diagnostics, offset, "Unrecognized export type '%s'.", raw);
+        } else {
+            diagnostics_error(diagnostics, offset, "Unrecognized export type '%s' (in '%s').", _type, raw);
         }
+        return false;
+    }
+
+    *out_info = (type_info_t) {
+        .export_type = export_type,
+        .flags = (is_resource ? EXPORT_FLAG_RESOURCE : 0) | (is_ptr ? EXPORT_FLAG_POINTER : 0) | (is_typed_array ? EXPORT_FLAG_TYPED_ARRAY : 0),
+        .hint = string_table_intern(&symbols->strings, _type, strlen(_type)),
+    };
+    return true;
+}
+
+// Looks up the fields of one export
+void get_export(const class_t* class, int index, export_view_t* out_export) {
+    const export_table_t* exports = &class->exports;
+    const string_table_t* strings = &class->symbols->strings;
+    *out_export = (export_view_t) {
+        .name = string_table_get(strings, exports->names[index]),
+        .type = string_table_get(strings, exports->types[index]),
+        .hint = string_table_get(strings, exports->hints[index]),
+        .notify_callback = exports->notify[index] != EXPORT_NOTIFY_NONE ? string_table_get(strings, exports->callbacks[index]) : NULL,
+        .export_type = exports->export_types[index],
+        .notify = exports->notify[index],
+        .flags = exports->flags[index],
+    };
+}
 
-        add_property(export, export_type, _type, file);
+// Writes the getter and setter of every export. specifier is written before each definition (i.e. "inline ")
+void write_accessor_functions(output_buffer_t* out, const class_t* class, const char* specifier) {
+    for (int i = 0; i < class->exports.count; i++) {
+        export_view_t view;
+        get_export(class, i, &view);
+        const export_view_t* export = &view;
+        output_append_literal(out, "\t");
+        output_append_string(out, specifier);
+        output_append_literal(out, "void ");
+        output_append_string(out, class->name);
+        output_append_literal(out, "::set_");
+        output_append_string(out, export->name);
+
+        // Anything that isn't a scalar or pointer is taken by const reference, so setting strings,
+        // containers and large math types doesn't copy or touch a refcount before the assignment
+        if (export_types_pass_by_value(export->export_type)) {
+            output_append_literal(out, "(");
+            output_append_string(out, export->type);
+            output_append_literal(out, " value) {\n\t\t");
+        } else {
+            output_append_literal(out, "(const ");
+            output_append_string(out, export->type);
+            output_append_literal(out, "& value) {\n\t\t");
+        }
+        if (export->notify != EXPORT_NOTIFY_NONE) {
+            write_notify_setter_body(out, class, export, specifier);
+        } else {
+            output_append_string(out, export->name);
+            output_append_literal(out, " = value; \n\t}\n\t");
+        }
+        output_append_string(out, specifier);
+        output_append_string(out, export->type);
+        output_append_literal(out, " ");
+        output_append_string(out, class->name);
+        output_append_literal(out, "::get_");
+        output_append_string(out, export->name);
+        output_append_literal(out, "() const {\n\t\treturn ");
+        output_append_string(out, export->name);
+        output_append_literal(out, ";\n\t}\n");
+
+        if (export->flags & EXPORT_FLAG_PACKED_ACCESSORS) {
+            write_packed_accessors(out, class, export, specifier);
+        }
     }
+}
 
-    // Close bind methods function
-    write_text("\n\t}\n", file);
+// Writes the span accessors of a GD_EXPORT_PACKED export. The view reads the array in place, the span writes it in place
+// (copying it once first if its storage is shared) and assign_*_from replaces its contents with a single resize
+void write_packed_accessors(output_buffer_t* out, const class_t* class, const export_view_t* export, const char* specifier) {
+    const char* element = export_types_packed_element(export->export_type);
+
+    output_append_literal(out, "\t");
+    output_append_string(out, specifier);
+    output_append_literal(out, "gd_span<const ");
+    output_append_string(out, element);
+    output_append_literal(out, "> ");
+    output_append_string(out, class->name);
+    output_append_literal(out, "::get_");
+    output_append_string(out, export->name);
+    output_append_literal(out, "_view() const {\n\t\treturn { ");
+    output_append_string(out, export->name);
+    output_append_literal(out, ".ptr(), (size_t)");
+    output_append_string(out, export->name);
+    output_append_literal(out, ".size() };\n\t}\n");
+
+    output_append_literal(out, "\t");
+    output_append_string(out, specifier);
+    output_append_literal(out, "gd_span<");
+    output_append_string(out, element);
+    output_append_literal(out, "> ");
+    output_append_string(out, class->name);
+    output_append_literal(out, "::get_");
+    output_append_string(out, export->name);
+    output_append_literal(out, "_span() {\n\t\treturn { ");
+    output_append_string(out, export->name);
+    output_append_literal(out, ".ptrw(), (size_t)");
+    output_append_string(out, export->name);
+    output_append_literal(out, ".size() };\n\t}\n");
+
+    output_append_literal(out, "\t");
+    output_append_string(out, specifier);
+    output_append_literal(out, "void ");
+    output_append_string(out, class->name);
+    output_append_literal(out, "::assign_");
+    output_append_string(out, export->name);
+    output_append_literal(out, "_from(const ");
+    output_append_string(out, element);
+    output_append_literal(out, "* data, size_t size) {\n\t\t");
+    output_append_string(out, export->name);
+    output_append_literal(out, ".resize((int64_t)size);\n\t\t");
+    output_append_string(out, element);
+    output_append_literal(out, "* out = ");
+    output_append_string(out, export->name);
+    output_append_literal(out, ".ptrw();\n\t\tfor (size_t i = 0; i < size; i++) {\n\t\t\tout[i] = data[i];\n\t\t}\n\t}\n");
+}
 
-    // Write getter and setter functions
-    for (int i = 0; i < class->export_count; i++) {
-        export_t* export = &class->exports[i];
-        snprintf(buffer, sizeof(buffer), 
-                "\tvoid %s::set_%s(%s value) {\n\t\t%s = value; \n\t}\n\t%s %s::get_%s() const {\n\t\treturn %s;\n\t}\n",
-                class->name,
-                export->name, export->type, export->name,
-                export->type, class->name, export->name, export->name);
-
-        write_text(buffer, file);
+// Writes the rest of a notifying setter, from the equality check to the line after its closing brace.
+// Deferred exports also get the function that runs their callback, which clears the pending flag first
+// so a callback that sets the property again is notified on the next frame
+void write_notify_setter_body(output_buffer_t* out, const class_t* class, const export_view_t* export, const char* specifier) {
+    output_append_literal(out, "if (");
+    output_append_string(out, export->name);
+    output_append_literal(out, " == value) {\n\t\t\treturn;\n\t\t}\n\t\t");
+    output_append_string(out, export->name);
+    output_append_literal(out, " = value;\n\t\t");
+
+    if (export->notify == EXPORT_NOTIFY_IMMEDIATE) {
+        output_append_string(out, export->notify_callback);
+        output_append_literal(out, "();\n\t}\n\t");
+        return;
     }
 
-    // Close namespace
-    write_text("}\n", file);
+    output_append_literal(out, "if (!");
+    output_append_string(out, export->name);
+    output_append_literal(out, "_notify_pending) {\n\t\t\t");
+    output_append_string(out, export->name);
+    output_append_literal(out, "_notify_pending = true;\n\t\t\tcallable_mp(this, &");
+    output_append_string(out, class->name);
+    output_append_literal(out, "::_flush_");
+    output_append_string(out, export->name);
+    output_append_literal(out, "_notify).call_deferred();\n\t\t}\n\t}\n\t");
+
+    output_append_string(out, specifier);
+    output_append_literal(out, "void ");
+    output_append_string(out, class->name);
+    output_append_literal(out, "::_flush_");
+    output_append_string(out, export->name);
+    output_append_literal(out, "_notify() {\n\t\t");
+    output_append_string(out, export->name);
+    output_append_literal(out, "_notify_pending = false;\n\t\t");
+    output_append_string(out, export->notify_callback);
+    output_append_literal(out, "();\n\t}\n\t");
 }
 
-// Private functions
-// Adds properties to godot editor
-void add_property(export_t* export, export_type_t type, const char* type_str, FILE* file) {
+// Describes how an export is added to the godot editor
+b8 describe_property(export_type_t export_type, property_desc_t* out_desc) {
     const char* variant_string = NULL;
-    char buffer[2048] = {};
-    switch (type) {
+    switch (export_type) {
         case EXPORT_TYPE_RESOURCE:
-            snprintf(buffer, sizeof(buffer), "\t\tADD_PROPERTY(PropertyInfo(Variant::OBJECT, \"%s\", PROPERTY_HINT_RESOURCE_TYPE, \"%s\"), \"set_%s\", \"get_%s\");\n", export->name, type_str, export->name, export->name);
-            write_text(buffer, file);
-            return;
+            *out_desc = (property_desc_t) { .variant_string = "OBJECT", .hint = "PROPERTY_HINT_RESOURCE_TYPE" };
+            return true;
         case EXPORT_TYPE_DOUBLE:
         case EXPORT_TYPE_FLOAT:
             variant_string = "FLOAT";
             break;
         case EXPORT_TYPE_NULL:
             log_error("Cannot add null property.");
-            abort();
-            return;
+            return false;
         case EXPORT_TYPE_INT:
             variant_string = "INT";
             break;
         case EXPORT_TYPE_NODE:
-            snprintf(buffer, sizeof(buffer), "\t\tADD_PROPERTY(PropertyInfo(Variant::OBJECT, \"%s\", PROPERTY_HINT_NODE_TYPE, \"%s\"), \"set_%s\", \"get_%s\");\n", export->name, type_str, export->name, export->name);
-            write_text(buffer, file);
-            return;
+            *out_desc = (property_desc_t) { .variant_string = "OBJECT", .hint = "PROPERTY_HINT_NODE_TYPE" };
+            return true;
         case EXPORT_TYPE_STRING:
             variant_string = "STRING";
             break;
         case EXPORT_TYPE_TYPED_ARRAY:
-            snprintf(buffer, 
-                    sizeof(buffer),
-                    "\t\tADD_PROPERTY(PropertyInfo(Variant::ARRAY, \"%s\", PROPERTY_HINT_TYPE_STRING, String::num(Variant::OBJECT) + \"/\" + String::num(PROPERTY_HINT_RESOURCE_TYPE) + \":%s\"), \"set_%s\", \"get_%s\");\n", 
-                    export->name,
-                    type_str,
-                    export->name,
-                    export->name);
-            write_text(buffer, file);
-            return;
         case EXPORT_TYPE_TYPED_RESOURCE_ARRAY:
-            snprintf(buffer, 
-                    sizeof(buffer),
-                    "\t\tADD_PROPERTY(PropertyInfo(Variant::ARRAY, \"%s\", PROPERTY_HINT_TYPE_STRING, String::num(Variant::OBJECT) + \"/\" + String::num(PROPERTY_HINT_RESOURCE_TYPE) + \":%s\"), \"set_%s\", \"get_%s\");\n", 
-                    export->name,
-                    type_str,
-                    export->name,
-                    export->name);
-            write_text(buffer, file);
-            return;
+            *out_desc = (property_desc_t) { .variant_string = "ARRAY", .hint = "PROPERTY_HINT_TYPE_STRING", .typed_array = true };
+            return true;
         case EXPORT_TYPE_BOOL:
             variant_string = "BOOL";
             break;
@@ -457,66 +675,271 @@ void add_property(export_t* export, export_type_t type, const char* type_str, FI
             break;
     }
 
-    // Writes variants since they only change one string
-    if (variant_string) {
-        snprintf(buffer, sizeof(buffer), "\t\tADD_PROPERTY(PropertyInfo(Variant::%s, \"%s\"), \"set_%s\", \"get_%s\");\n", variant_string, export->name, export->name, export->name);
-        write_text(buffer, file);
-    }
+    // Plain variants only differ by their type
+    *out_desc = (property_desc_t) { .variant_string = variant_string };
+    return true;
 }
 
-void parse_group(const char* line, char** out_name, char** out_prefix) {
-    // Find (
-    int line_length = strlen(line);
-    int start = 0;
+// Binds the getter and setter of an export
+void write_bind_methods(output_buffer_t* out, const class_t* class, const export_view_t* export) {
+    output_append_literal(out, "\t\tClassDB::bind_method(D_METHOD(\"get_");
+    output_append_string(out, export->name);
+    output_append_literal(out, "\"), &");
+    output_append_string(out, class->name);
+    output_append_literal(out, "::get_");
+    output_append_string(out, export->name);
+    output_append_literal(out, ");\n");
+
+    output_append_literal(out, "\t\tClassDB::bind_method(D_METHOD(\"set_");
+    output_append_string(out, export->name);
+    output_append_literal(out, "\", \"");
+    output_append_string(out, export->name);
+    output_append_literal(out, "\"), &");
+    output_append_string(out, class->name);
+    output_append_literal(out, "::set_");
+    output_append_string(out, export->name);
+    output_append_literal(out, ");\n");
+}
 
-    for (int i = 0; i < line_length; i++) {
-        const char c = line[i];
-        if (c == '(') {
-            start = i + 1;
-            break;
+// Writes an ADD_PROPERTY line. Typed array hints are built at runtime from Godot's enum values
+void write_property(output_buffer_t* out, const export_view_t* export, const property_desc_t* desc) {
+    if (!desc->variant_string) {
+        return;
+    }
+
+    output_append_literal(out, "\t\tADD_PROPERTY(PropertyInfo(Variant::");
+    output_append_string(out, desc->variant_string);
+    output_append_literal(out, ", \"");
+    output_append_string(out, export->name);
+    output_append_literal(out, "\"");
+    if (desc->hint) {
+        output_append_literal(out, ", ");
+        output_append_string(out, desc->hint);
+        if (desc->typed_array) {
+            output_append_literal(out, ", String::num(Variant::OBJECT) + \"/\" + String::num(PROPERTY_HINT_RESOURCE_TYPE) + \":");
+        } else {
+            output_append_literal(out, ", \"");
         }
+        output_append_string(out, export->hint);
+        output_append_literal(out, "\"");
     }
+    output_append_literal(out, "), \"set_");
+    output_append_string(out, export->name);
+    output_append_literal(out, "\", \"get_");
+    output_append_string(out, export->name);
+    output_append_literal(out, "\");\n");
+}
 
-    // Find ',' (marks end of name)
-    int name_end = start;
-    for (int i = start; i < line_length; i++) {
-        const char c = line[i];
-        if (c == ',') {
-            name_end = i - 1;
-            break;
+// Writes every property, group and subgroup of a class as one constant table and registers it with a single loop.
+// Typed array hints are precomputed, so no hint string is built at runtime
+void write_property_table(output_buffer_t* out, const class_t* class, const property_desc_t* descs) {
+    output_append_literal(out, "\n\t\tstatic const gdcg_property properties[] = {\n");
+    int group = -1;
+    int subgroup = -1;
+    for (int i = 0; i < class->exports.count; i++) {
+        while (group < class->exports.groups[i]) {
+            write_table_group(out, "GDCG_GROUP", &class->groups[++group]);
+        }
+        while (subgroup < class->exports.subgroups[i]) {
+            write_table_group(out, "GDCG_SUBGROUP", &class->subgroups[++subgroup]);
         }
+
+        const property_desc_t* desc = &descs[i];
+        if (!desc->variant_string) {
+            continue;
+        }
+        export_view_t view;
+        get_export(class, i, &view);
+        const export_view_t* export = &view;
+
+        output_append_literal(out, "\t\t\t{ GDCG_PROPERTY, Variant::");
+        output_append_string(out, desc->variant_string);
+        output_append_literal(out, ", ");
+        output_append_string(out, desc->hint ? desc->hint : "PROPERTY_HINT_NONE");
+        output_append_literal(out, ", \"");
+        output_append_string(out, export->name);
+        output_append_literal(out, "\", \"");
+        if (desc->typed_array) {
+            output_append_literal(out, VARIANT_OBJECT_VALUE "/" PROPERTY_HINT_RESOURCE_TYPE_VALUE ":");
+        }
+        if (desc->hint) {
+            output_append_string(out, export->hint);
+        }
+        output_append_literal(out, "\", \"set_");
+        output_append_string(out, export->name);
+        output_append_literal(out, "\", \"get_");
+        output_append_string(out, export->name);
+        output_append_literal(out, "\" },\n");
     }
+    output_append_literal(out, "\t\t};\n");
+    output_append_literal(out, "\t\tgdcg_register_properties(get_class_static(), properties, sizeof(properties) / sizeof(properties[0]));\n");
+}
 
-    // Find start of prefix
-    int prefix_start = name_end + 2;
-    for (int i = prefix_start; i < line_length; i++) {
-        const char c = line[i];
-        if (c != ' ') {
-            prefix_start = i;
-            break;
+// Writes a group or subgroup entry of a property table
+void write_table_group(output_buffer_t* out, const char* kind, const group_t* group) {
+    output_append_literal(out, "\t\t\t{ ");
+    output_append_string(out, kind);
+    output_append_literal(out, ", Variant::NIL, PROPERTY_HINT_NONE, \"");
+    output_append_string(out, group->name);
+    output_append_literal(out, "\", \"");
+    output_append_string(out, group->prefix);
+    output_append_literal(out, "\", nullptr, nullptr },\n");
+}
+
+// Writes an ADD_GROUP or ADD_SUBGROUP line. macro_start includes the opening quote
+void write_group(output_buffer_t* out, const char* macro_start, const group_t* group) {
+    output_append_string(out, macro_start);
+    output_append_string(out, group->name);
+    output_append_literal(out, "\", \"");
+    output_append_string(out, group->prefix);
+    output_append_literal(out, "\");\n");
+}
+
+// Reads the parenthesized arguments after a marker, including the closing parenthesis. Arguments are split on commas
+// outside of nested parentheses and template brackets, so GD_EXPORT(HashMap<int, float>, map) has two.
+// On errors the lexer is left where the surrounding code can carry on, after the closing parenthesis or before the
+// ';', '{' or '}' that ended the marker early
+b8 read_marker_arguments(lexer_t* lexer, const token_t* marker, diagnostics_t* diagnostics, marker_argument_t* arguments, int* out_count) {
+    const char* text = lexer->text;
+    long position = lexer->position;
+    token_t token;
+    if (!lexer_next_code(lexer, &token) || !token_is(lexer, &token, '(')) {
+        diagnostics_error(diagnostics, marker->start, "Expected '(' after '%.*s'.", (int)marker->length, text + marker->start);
+        lexer->position = position;
+        return false;
+    }
+
+    int count = 1;
+    int depth = 1;
+    int angle_depth = 0;
+    b8 too_many = false;
+    arguments[0] = (marker_argument_t) { 0 };
+    position = lexer->position;
+    while (lexer_next_code(lexer, &token)) {
+        if (token.kind == TOKEN_PUNCTUATION) {
+            const char c = text[token.start];
+            if (c == ';' || c == '{' || c == '}') {
+                lexer->position = position;
+                break;
+            }
+            if (c == ')' && --depth == 0) {
+                if (too_many) {
+                    diagnostics_error(diagnostics, marker->start, "Too many arguments for '%.*s'.", (int)marker->length, text + marker->start);
+                    return false;
+                }
+                *out_count = count;
+                return true;
+            }
+            if (c == ',' && depth == 1 && angle_depth == 0) {
+                // Extra arguments are skipped up to the closing parenthesis, so parsing carries on after it
+                if (count == MARKER_ARGUMENT_MAX) {
+                    too_many = true;
+                } else {
+                    arguments[count++] = (marker_argument_t) { 0 };
+                }
+                position = lexer->position;
+                continue;
+            }
+
+            if (c == '(') {
+                depth++;
+            } else if (c == '<') {
+                angle_depth++;
+            } else if (c == '>' && angle_depth > 0) {
+                angle_depth--;
+            }
         }
+
+        marker_argument_t* argument = &arguments[count - 1];
+        if (argument->token_count++ == 0) {
+            argument->first = token;
+        }
+        argument->end = token.start + token.length;
+        position = lexer->position;
     }
 
-    // Find end of prefix
-    int prefix_end = prefix_start;
-    for (int i = prefix_start; i < line_length; i++) {
-        const char c = line[i];
-        if (c == ')') {
-            prefix_end = i - 1;
-            break;
+    diagnostics_error(diagnostics, marker->start, "Missing ')' after '%.*s'.", (int)marker->length, text + marker->start);
+    return false;
+}
+
+// GD_EXPORT(type, name), GD_EXPORT_PACKED(type, name) or GD_EXPORT_NOTIFY[_DEFERRED](type, name, callback)
+b8 parse_export(class_t* class, const lexer_t* lexer, const token_t* marker, diagnostics_t* diagnostics, const marker_argument_t* arguments, int argument_count) {
+    const char* text = lexer->text;
+    export_notify_t notify = EXPORT_NOTIFY_NONE;
+    if (marker->marker == TOKEN_MARKER_EXPORT_NOTIFY) {
+        notify = EXPORT_NOTIFY_IMMEDIATE;
+    } else if (marker->marker == TOKEN_MARKER_EXPORT_NOTIFY_DEFERRED) {
+        notify = EXPORT_NOTIFY_DEFERRED;
+    }
+
+    // Ensure that both a name and type were found
+    const int expected_count = notify != EXPORT_NOTIFY_NONE ? 3 : 2;
+    const marker_argument_t* type = &arguments[0];
+    const marker_argument_t* name = &arguments[1];
+    if (argument_count < 2 || type->token_count == 0 || name->token_count != 1 || name->first.kind != TOKEN_IDENTIFIER) {
+        diagnostics_error(diagnostics, marker->start, "Failed to get export data. Expected '%.*s(type, name%s)'.", (int)marker->length, text + marker->start,
+                notify != EXPORT_NOTIFY_NONE ? ", callback" : "");
+        return false;
+    }
+
+    const marker_argument_t* callback = &arguments[2];
+    if (argument_count != expected_count || (notify != EXPORT_NOTIFY_NONE && (callback->token_count != 1 || callback->first.kind != TOKEN_IDENTIFIER))) {
+        if (notify != EXPORT_NOTIFY_NONE) {
+            diagnostics_error(diagnostics, marker->start, "Notifying export '%.*s' needs a callback. Expected '%.*s(type, name, callback)'.",
+                    (int)name->first.length, text + name->first.start, (int)marker->length, text + marker->start);
+        } else {
+            diagnostics_error(diagnostics, marker->start, "Export '%.*s' takes a type and a name only.", (int)name->first.length, text + name->first.start);
         }
+        return false;
     }
 
-    // Create strings
-    int name_length = name_end - start + 2;
-    int prefix_length = prefix_end - prefix_start + 2;
+    // Add exports to the class
+    export_table_t* exports = &class->exports;
+    class_reserve_exports(class, exports->count + 1);
+    const int index = exports->count++;
+    exports->names[index] = intern_argument(class, lexer, name);
+    exports->types[index] = intern_argument(class, lexer, type);
+    exports->callbacks[index] = notify != EXPORT_NOTIFY_NONE ? intern_argument(class, lexer, callback) : STRING_ID_EMPTY;
+    exports->notify[index] = notify;
+    exports->flags[index] = marker->marker == TOKEN_MARKER_EXPORT_PACKED ? EXPORT_FLAG_PACKED_ACCESSORS : 0;
+    exports->groups[index] = class->group_count - 1;
+    exports->subgroups[index] = class->subgroup_count - 1;
+    exports->offsets[index] = type->first.start;
+    exports->export_types[index] = EXPORT_TYPE_NULL;
+    exports->hints[index] = STRING_ID_EMPTY;
+    return true;
+}
 
-    *out_name = malloc(name_length);
-    *out_prefix = malloc(prefix_length);
+// GD_GROUP(name, prefix) or GD_SUBGROUP(name, prefix). The prefix may be left out or empty
+void parse_group(class_t* class, const lexer_t* lexer, group_t* group, const marker_argument_t* arguments, int argument_count) {
+    group->name = copy_argument(class, lexer, &arguments[0]);
+    group->prefix = argument_count > 1 ? copy_argument(class, lexer, &arguments[1]) : "";
+}
+
+// Copies the text of an argument into the class arena. Whitespace inside it is kept, i.e. "const Ref<Texture2D>"
+const char* copy_argument(class_t* class, const lexer_t* lexer, const marker_argument_t* argument) {
+    if (argument->token_count == 0) {
+        return "";
+    }
+    return arena_copy_string(class->arena, lexer->text + argument->first.start, argument->end - argument->first.start);
+}
 
-    strncpy(*out_name, line + start, name_length);
-    strncpy(*out_prefix, line + prefix_start, prefix_length);
+// Interns the text of an argument in the file's string table
+string_id_t intern_argument(class_t* class, const lexer_t* lexer, const marker_argument_t* argument) {
+    if (argument->token_count == 0) {
+        return STRING_ID_EMPTY;
+    }
+    return string_table_intern(&class->symbols->strings, lexer->text + argument->first.start, argument->end - argument->first.start);
+}
+
+// Makes room for one more element in an arena backed array and returns the (possibly moved) array
+void* reserve_element(arena_t* arena, void* data, int count, int* capacity, size_t element_size) {
+    if (count < *capacity) {
+        return data;
+    }
 
-    (*out_name)[name_length - 1] = 0;
-    (*out_prefix)[prefix_length - 1] = 0;
+    int new_capacity = *capacity ? *capacity * 2 : 16;
+    data = arena_grow(arena, data, element_size * *capacity, element_size * new_capacity);
+    *capacity = new_capacity;
+    return data;
 }
@@ -0,0 +1,43 @@
+#include "code_gen/depfile.h"
+#include "code_gen/file_utils.h"
+#include "code_gen/output_buffer.h"
+
+#include <string.h>
+
+// Private functions
+static void append_path(output_buffer_t* out, const char* path);
+
+// Function Impls
+b8 depfile_write(const char* depfile_path, const char** targets, int target_count, const char** inputs, int input_count) {
+    output_buffer_t out;
+    output_buffer_init(&out);
+
+    for (int i = 0; i < target_count; i++) {
+        if (i > 0) {
+            output_append_literal(&out, " ");
+        }
+        append_path(&out, targets[i]);
+    }
+    output_append_literal(&out, ":");
+    for (int i = 0; i < input_count; i++) {
+        output_append_literal(&out, " \\\n  ");
+        append_path(&out, inputs[i]);
+    }
+    output_append_literal(&out, "\n");
+
+    b8 success = write_file_if_changed(depfile_path, out.data, out.size, NULL);
+    output_buffer_free(&out);
+    return success;
+}
+
+// Private functions
+static void append_path(output_buffer_t* out, const char* path) {
+    for (const char* c = path; *c; c++) {
+        if (*c == ' ' || *c == '#') {
+            output_append_literal(out, "\\");
+        } else if (*c == '$') {
+            output_append_literal(out, "$");
+        }
+        output_append(out, c, 1);
+    }
+}
@@ -0,0 +1,208 @@
+#include "code_gen/diagnostics.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Private data
+#define MESSAGE_BUFFER_SIZE 512
+
+static const char* severity_names[2] = { "warning", "error" };
+static const char* severity_colors[2] = { "\x1B[1;35m", "\x1B[1;31m" };
+static const char* color_reset = "\x1B[0m";
+
+// Totals of every flushed file, updated atomically since each worker flushes its own diagnostics
+static int total_errors = 0;
+static int total_warnings = 0;
+
+// Private functions
+static int compare_diagnostics(const void* a, const void* b);
+static void append_number(output_buffer_t* out, long number);
+static void write_all(const char* data, size_t size);
+
+// Function Impls
+void diagnostics_init(diagnostics_t* diagnostics) {
+    memset(diagnostics, 0, sizeof(diagnostics_t));
+    output_buffer_init(&diagnostics->messages);
+}
+
+void diagnostics_free(diagnostics_t* diagnostics) {
+    free(diagnostics->items);
+    output_buffer_free(&diagnostics->messages);
+    memset(diagnostics, 0, sizeof(diagnostics_t));
+}
+
+void diagnostics_begin(diagnostics_t* diagnostics, const char* path, const char* text, long text_length) {
+    diagnostics->path = path;
+    diagnostics->text = text;
+    diagnostics->text_length = text_length;
+    diagnostics->count = 0;
+    diagnostics->error_count = 0;
+    output_buffer_reset(&diagnostics->messages);
+}
+
+void diagnostics_report(diagnostics_t* diagnostics, diagnostic_severity_t severity, long offset, const char* format, ...) {
+    if (diagnostics->count >= diagnostics->capacity) {
+        diagnostics->capacity = diagnostics->capacity ? diagnostics->capacity * 2 : 16;
+        diagnostics->items = realloc(diagnostics->items, sizeof(diagnostic_t) * diagnostics->capacity);
+    }
+
+    diagnostics->items[diagnostics->count] = (diagnostic_t) {
+        .severity = severity,
+        .offset = offset,
+        .message_start = diagnostics->messages.size,
+        .index = diagnostics->count,
+    };
+    diagnostics->count++;
+    if (severity == DIAGNOSTIC_ERROR) {
+        diagnostics->error_count++;
+    }
+
+    // Messages are short, the rare long one (i.e. with a long type in it) is formatted twice
+    char message[MESSAGE_BUFFER_SIZE];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    if (length < 0) {
+        length = 0;
+        message[0] = 0;
+    }
+
+    if ((size_t)length < sizeof(message)) {
+        output_append(&diagnostics->messages, message, length + 1);
+        return;
+    }
+
+    char* long_message = malloc(length + 1);
+    va_start(args, format);
+    vsnprintf(long_message, length + 1, format, args);
+    va_end(args);
+    output_append(&diagnostics->messages, long_message, length + 1);
+    free(long_message);
+}
+
+void diagnostics_flush(diagnostics_t* diagnostics) {
+    if (diagnostics->count == 0) {
+        return;
+    }
+
+    qsort(diagnostics->items, diagnostics->count, sizeof(diagnostic_t), compare_diagnostics);
+    const b8 use_color = !diagnostics->capture && isatty(STDERR_FILENO);
+
+    // Sorted by offset, so lines are counted in a single pass over the text
+    output_buffer_t rendered;
+    output_buffer_init(&rendered);
+    output_buffer_t* out = diagnostics->capture ? diagnostics->capture : &rendered;
+    long line = 1;
+    long line_start = 0;
+    long position = 0;
+    for (int i = 0; i < diagnostics->count; i++) {
+        const diagnostic_t* diagnostic = &diagnostics->items[i];
+        const long offset = diagnostic->offset < diagnostics->text_length ? diagnostic->offset : diagnostics->text_length;
+        while (offset >= 0 && position < offset) {
+            const char* newline = memchr(diagnostics->text + position, '\n', offset - position);
+            if (!newline) {
+                position = offset;
+                break;
+            }
+            position = newline - diagnostics->text + 1;
+            line_start = position;
+            line++;
+        }
+
+        output_append_string(out, diagnostics->path);
+        if (offset >= 0) {
+            output_append_literal(out, ":");
+            append_number(out, line);
+            output_append_literal(out, ":");
+            append_number(out, offset - line_start + 1);
+        }
+        output_append_literal(out, ": ");
+        if (use_color) {
+            output_append_string(out, severity_colors[diagnostic->severity]);
+        }
+        output_append_string(out, severity_names[diagnostic->severity]);
+        output_append_literal(out, ":");
+        if (use_color) {
+            output_append_string(out, color_reset);
+        }
+        output_append_literal(out, " ");
+        output_append_string(out, diagnostics->messages.data + diagnostic->message_start);
+        output_append_literal(out, "\n");
+    }
+
+    if (diagnostics->capture) {
+        diagnostics->captured_error_count += diagnostics->error_count;
+        diagnostics->captured_warning_count += diagnostics->count - diagnostics->error_count;
+    } else {
+        write_all(rendered.data, rendered.size);
+        __atomic_add_fetch(&total_errors, diagnostics->error_count, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&total_warnings, diagnostics->count - diagnostics->error_count, __ATOMIC_RELAXED);
+    }
+    output_buffer_free(&rendered);
+
+    diagnostics->count = 0;
+    diagnostics->error_count = 0;
+    output_buffer_reset(&diagnostics->messages);
+}
+
+void diagnostics_forward(const char* text, size_t size, int error_count, int warning_count) {
+    write_all(text, size);
+    __atomic_add_fetch(&total_errors, error_count, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&total_warnings, warning_count, __ATOMIC_RELAXED);
+}
+
+void diagnostics_print_summary(void) {
+    const int errors = __atomic_load_n(&total_errors, __ATOMIC_RELAXED);
+    const int warnings = __atomic_load_n(&total_warnings, __ATOMIC_RELAXED);
+    if (errors == 0 && warnings == 0) {
+        return;
+    }
+
+    char summary[128];
+    int length = 0;
+    if (errors > 0 && warnings > 0) {
+        length = snprintf(summary, sizeof(summary), "%d error%s and %d warning%s generated.\n",
+                errors, errors == 1 ? "" : "s", warnings, warnings == 1 ? "" : "s");
+    } else if (errors > 0) {
+        length = snprintf(summary, sizeof(summary), "%d error%s generated.\n", errors, errors == 1 ? "" : "s");
+    } else {
+        length = snprintf(summary, sizeof(summary), "%d warning%s generated.\n", warnings, warnings == 1 ? "" : "s");
+    }
+    write_all(summary, length);
+}
+
+// Private functions
+static int compare_diagnostics(const void* a, const void* b) {
+    const diagnostic_t* diagnostic_a = a;
+    const diagnostic_t* diagnostic_b = b;
+    if (diagnostic_a->offset != diagnostic_b->offset) {
+        return diagnostic_a->offset < diagnostic_b->offset ? -1 : 1;
+    }
+    return diagnostic_a->index - diagnostic_b->index;
+}
+
+static void append_number(output_buffer_t* out, long number) {
+    char digits[24];
+    int length = snprintf(digits, sizeof(digits), "%ld", number);
+    output_append(out, digits, length);
+}
+
+static void write_all(const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(STDERR_FILENO, data, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return;
+        }
+
+        data += written;
+        size -= written;
+    }
+}
@@ -0,0 +1,217 @@
+#include "code_gen/export_types.h"
+#include "code_gen/logging.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Private data
+#define MAX_SEED_ATTEMPTS 100000
+
+// Private structs
+typedef struct type_slot {
+    const char* alias; // NULL if the slot is empty
+    int alias_length;
+    export_type_t type;
+} type_slot_t;
+
+typedef struct type_table {
+    type_slot_t* slots;
+    unsigned int slot_mask;
+    unsigned long long seed;
+
+    // Registered aliases. Strings are owned by the table
+    type_slot_t* extra_aliases;
+    int extra_alias_count;
+    int extra_alias_capacity;
+} type_table_t;
+
+static type_table_t table = {};
+static pthread_once_t table_once = PTHREAD_ONCE_INIT;
+
+// Private functions
+static void build_default_table(void);
+static b8 build_table(void);
+static b8 try_seed(type_slot_t* slots, unsigned int slot_mask, unsigned long long seed);
+static unsigned int hash_type(const char* type, int length, unsigned long long seed);
+
+// Function Impls
+export_type_t export_types_lookup(const char* type, int length) {
+    pthread_once(&table_once, build_default_table);
+
+    const type_slot_t* slot = &table.slots[hash_type(type, length, table.seed) & table.slot_mask];
+    if (slot->alias && slot->alias_length == length && memcmp(slot->alias, type, length) == 0) {
+        return slot->type;
+    }
+
+    return EXPORT_TYPE_NULL;
+}
+
+b8 export_types_register_alias(const char* alias, const char* target) {
+    pthread_once(&table_once, build_default_table);
+
+    export_type_t type = export_types_lookup(target, strlen(target));
+    if (type == EXPORT_TYPE_NULL) {
+        log_error("Cannot alias '%s' to unknown type '%s'.", alias, target);
+        return false;
+    }
+
+    int alias_length = strlen(alias);
+    export_type_t existing = export_types_lookup(alias, alias_length);
+    if (existing == type) {
+        return true;
+    }
+    if (existing != EXPORT_TYPE_NULL) {
+        log_error("'%s' is already an alias for a different type.", alias);
+        return false;
+    }
+
+    if (table.extra_alias_count >= table.extra_alias_capacity) {
+        table.extra_alias_capacity = table.extra_alias_capacity ? table.extra_alias_capacity * 2 : 16;
+        table.extra_aliases = realloc(table.extra_aliases, sizeof(type_slot_t) * table.extra_alias_capacity);
+    }
+    table.extra_aliases[table.extra_alias_count++] = (type_slot_t) {
+        .alias = strdup(alias),
+        .alias_length = alias_length,
+        .type = type,
+    };
+
+    // Fold the new alias into the table so lookups stay a single probe
+    if (!build_table()) {
+        table.extra_alias_count--;
+        free((char*)table.extra_aliases[table.extra_alias_count].alias);
+        build_table();
+        return false;
+    }
+
+    return true;
+}
+
+b8 export_types_register_alias_pair(const char* pair) {
+    const char* separator = strchr(pair, '=');
+    if (!separator || separator == pair || separator[1] == 0) {
+        log_error("Invalid alias '%s'. Expected alias=type (i.e. real_t=float).", pair);
+        return false;
+    }
+
+    char* alias = strndup(pair, separator - pair);
+    b8 success = export_types_register_alias(alias, separator + 1);
+    free(alias);
+    return success;
+}
+
+b8 export_types_pass_by_value(export_type_t type) {
+    switch (type) {
+        case EXPORT_TYPE_BOOL:
+        case EXPORT_TYPE_INT:
+        case EXPORT_TYPE_FLOAT:
+        case EXPORT_TYPE_DOUBLE:
+        case EXPORT_TYPE_RID:
+        case EXPORT_TYPE_NODE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+const char* export_types_packed_element(export_type_t type) {
+    switch (type) {
+        case EXPORT_TYPE_PACKED_BYTE_ARRAY:    return "uint8_t";
+        case EXPORT_TYPE_PACKED_INT32_ARRAY:   return "int32_t";
+        case EXPORT_TYPE_PACKED_INT64_ARRAY:   return "int64_t";
+        case EXPORT_TYPE_PACKED_FLOAT32_ARRAY: return "float";
+        case EXPORT_TYPE_PACKED_FLOAT64_ARRAY: return "double";
+        case EXPORT_TYPE_PACKED_STRING_ARRAY:  return "String";
+        case EXPORT_TYPE_PACKED_VECTOR2_ARRAY: return "Vector2";
+        case EXPORT_TYPE_PACKED_VECTOR3_ARRAY: return "Vector3";
+        case EXPORT_TYPE_PACKED_COLOR_ARRAY:   return "Color";
+        case EXPORT_TYPE_PACKED_VECTOR4_ARRAY: return "Vector4";
+        default:                               return NULL;
+    }
+}
+
+// Private functions
+static void build_default_table(void) {
+    if (!build_table()) {
+        log_fatal("Failed to build export type table.");
+    }
+}
+
+// Finds a seed that gives every alias its own slot, doubling the table if no seed is found
+static b8 build_table(void) {
+    int alias_count = table.extra_alias_count;
+    for (int i = 0; i < export_type_alias_count; i++) {
+        alias_count += export_type_aliases[i].alias_count;
+    }
+
+    unsigned int slot_count = 64;
+    while (slot_count < (unsigned int)alias_count * 4) {
+        slot_count *= 2;
+    }
+
+    for (; slot_count <= (1u << 20); slot_count *= 2) {
+        type_slot_t* slots = malloc(sizeof(type_slot_t) * slot_count);
+        for (unsigned long long seed = 0; seed < MAX_SEED_ATTEMPTS; seed++) {
+            if (!try_seed(slots, slot_count - 1, seed)) {
+                continue;
+            }
+
+            free(table.slots);
+            table.slots = slots;
+            table.slot_mask = slot_count - 1;
+            table.seed = seed;
+            return true;
+        }
+        free(slots);
+    }
+
+    return false;
+}
+
+static b8 try_seed(type_slot_t* slots, unsigned int slot_mask, unsigned long long seed) {
+    memset(slots, 0, sizeof(type_slot_t) * (slot_mask + 1));
+
+    for (int i = 0; i < export_type_alias_count + table.extra_alias_count; i++) {
+        // Built in aliases first, then registered ones
+        const char* const* aliases;
+        int alias_count;
+        export_type_t type;
+        type_slot_t extra_alias;
+        if (i < export_type_alias_count) {
+            aliases = export_type_aliases[i].aliases;
+            alias_count = export_type_aliases[i].alias_count;
+            type = export_type_aliases[i].type;
+        } else {
+            extra_alias = table.extra_aliases[i - export_type_alias_count];
+            aliases = &extra_alias.alias;
+            alias_count = 1;
+            type = extra_alias.type;
+        }
+
+        for (int j = 0; j < alias_count; j++) {
+            int length = strlen(aliases[j]);
+            type_slot_t* slot = &slots[hash_type(aliases[j], length, seed) & slot_mask];
+            if (slot->alias) {
+                // The same alias listed twice isn't a collision
+                if (slot->alias_length == length && memcmp(slot->alias, aliases[j], length) == 0) {
+                    continue;
+                }
+                return false;
+            }
+
+            *slot = (type_slot_t) { .alias = aliases[j], .alias_length = length, .type = type };
+        }
+    }
+
+    return true;
+}
+
+// Seeded FNV-1a
+static unsigned int hash_type(const char* type, int length, unsigned long long seed) {
+    unsigned long long hash = 0xcbf29ce484222325ULL ^ (seed * 0x9e3779b97f4a7c15ULL);
+    for (int i = 0; i < length; i++) {
+        hash ^= (unsigned char)type[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return (unsigned int)(hash ^ (hash >> 32));
+}
@@ -0,0 +1,123 @@
+#include "code_gen/file_utils.h"
+#include "code_gen/logging.h"
+#include "code_gen/trace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Private data
+static unsigned int temp_file_counter = 0;
+
+// Private functions
+static b8 write_file(const char* path, const char* data, size_t size, b8* out_changed);
+static b8 file_matches(const char* path, const char* data, size_t size);
+static b8 write_all(int fd, const char* data, size_t size);
+
+// Function Impls
+b8 write_file_if_changed(const char* path, const char* data, size_t size, b8* out_changed) {
+    trace_span_t span = trace_begin(TRACE_SPAN_WRITE);
+    b8 success = write_file(path, data, size, out_changed);
+    trace_end(span, path);
+    return success;
+}
+
+// Private functions
+static b8 write_file(const char* path, const char* data, size_t size, b8* out_changed) {
+    if (out_changed) {
+        *out_changed = false;
+    }
+
+    if (file_matches(path, data, size)) {
+        return true;
+    }
+
+    // Unique per process and per call so parallel workers never share a temporary file
+    char temp_path[4096];
+    unsigned int counter = __atomic_fetch_add(&temp_file_counter, 1, __ATOMIC_RELAXED);
+    int temp_path_length = snprintf(temp_path, sizeof(temp_path), "%s.tmp%d.%u", path, (int)getpid(), counter);
+    if (temp_path_length < 0 || temp_path_length >= (int)sizeof(temp_path)) {
+        log_error("Output path '%s' is too long.", path);
+        return false;
+    }
+
+    int fd = open(temp_path, O_WRONLY | O_CREAT | O_EXCL | O_TRUNC, 0666);
+    if (fd < 0) {
+        log_error("Failed to create '%s': %s", temp_path, strerror(errno));
+        return false;
+    }
+
+    b8 written = write_all(fd, data, size);
+    if (close(fd) != 0) {
+        written = false;
+    }
+    if (!written) {
+        log_error("Failed to write '%s': %s", temp_path, strerror(errno));
+        unlink(temp_path);
+        return false;
+    }
+
+    if (rename(temp_path, path) != 0) {
+        log_error("Failed to replace '%s': %s", path, strerror(errno));
+        unlink(temp_path);
+        return false;
+    }
+
+    if (out_changed) {
+        *out_changed = true;
+    }
+    return true;
+}
+
+static b8 file_matches(const char* path, const char* data, size_t size) {
+    // Cheap size check first since most changed files also change length
+    struct stat file_stat;
+    if (stat(path, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) || (size_t)file_stat.st_size != size) {
+        return false;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    // Compare in chunks so large outputs don't need a second full buffer
+    char buffer[16384];
+    size_t offset = 0;
+    b8 matches = true;
+    while (matches && offset < size) {
+        size_t chunk = size - offset < sizeof(buffer) ? size - offset : sizeof(buffer);
+        ssize_t read_count = read(fd, buffer, chunk);
+        if (read_count <= 0) {
+            matches = false;
+            break;
+        }
+
+        matches = memcmp(buffer, data + offset, read_count) == 0;
+        offset += read_count;
+    }
+
+    close(fd);
+    return matches;
+}
+
+static b8 write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        data += written;
+        size -= written;
+    }
+
+    return true;
+}
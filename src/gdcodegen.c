@@ -0,0 +1,98 @@
+#include "gdcodegen.h"
+#include "code_gen/export_types.h"
+#include "code_gen/generator.h"
+#include "code_gen/logging.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Private data
+#define DEFAULT_SOURCE_PATH "source.h"
+
+// Private functions
+static char* take_buffer(output_buffer_t* buffer, size_t* out_size);
+
+// Function Impls
+int gdcg_generate(const char* src, size_t len, const gdcg_options* options, gdcg_output* out) {
+    if (!out) {
+        return -1;
+    }
+    memset(out, 0, sizeof(gdcg_output));
+    if ((!src && len > 0) || len > LONG_MAX) {
+        return -1;
+    }
+
+    const char* source_path = options && options->source_path ? options->source_path : DEFAULT_SOURCE_PATH;
+
+    // A generator per call keeps calls independent. Everything it allocated is either handed to out or freed
+    generator_t generator;
+    generator_init(&generator);
+    generator.property_table = options && options->property_table;
+    generator.write_inline = options && options->inline_accessors;
+
+    output_buffer_t diagnostics;
+    output_buffer_init(&diagnostics);
+    generator.diagnostics.capture = &diagnostics;
+
+    // The generator logs problems that aren't tied to a place in the header (i.e. a class that fails to emit).
+    // Those go to the diagnostics as well, the library never prints
+    log_capture_t capture = { .messages = &diagnostics, .path = source_path };
+    log_set_capture(&capture);
+
+    generator_load_text(&generator, src, len);
+    const char* output = NULL;
+    size_t output_size = 0;
+    b8 success = generator_render(&generator, source_path, &output, &output_size);
+    if (success) {
+        out->source = take_buffer(&generator.output, &out->source_size);
+        if (generator.write_inline) {
+            generator_emit_inline(&generator, source_path, &output, &output_size);
+            out->inline_source = take_buffer(&generator.inline_output, &out->inline_size);
+        }
+    }
+    log_set_capture(NULL);
+
+    if (diagnostics.size > 0) {
+        out->diagnostics = take_buffer(&diagnostics, &out->diagnostics_size);
+    }
+    out->error_count = generator.diagnostics.captured_error_count + capture.error_count;
+    out->warning_count = generator.diagnostics.captured_warning_count + capture.warning_count;
+
+    output_buffer_free(&diagnostics);
+    generator_shutdown(&generator);
+    return success ? 0 : -1;
+}
+
+void gdcg_output_free(gdcg_output* out) {
+    if (!out) {
+        return;
+    }
+
+    free(out->source);
+    free(out->inline_source);
+    free(out->diagnostics);
+    memset(out, 0, sizeof(gdcg_output));
+}
+
+int gdcg_register_alias(const char* alias, const char* target) {
+    if (!alias || !target || !alias[0]) {
+        return -1;
+    }
+    // Failures are reported through the return value only
+    log_capture_t capture = { 0 };
+    log_set_capture(&capture);
+    b8 registered = export_types_register_alias(alias, target);
+    log_set_capture(NULL);
+    return registered ? 0 : -1;
+}
+
+// Private functions
+// Hands the buffer's memory to the caller NUL terminated, leaving the buffer empty
+static char* take_buffer(output_buffer_t* buffer, size_t* out_size) {
+    output_append(buffer, "", 1);
+    char* data = buffer->data;
+    *out_size = buffer->size - 1;
+    output_buffer_init(buffer);
+    return data;
+}
@@ -0,0 +1,452 @@
+// memmem
+#define _GNU_SOURCE
+
+#include "code_gen/generator.h"
+#include "code_gen/class_parser.h"
+#include "code_gen/depfile.h"
+#include "code_gen/file_utils.h"
+#include "code_gen/ir.h"
+#include "code_gen/lexer.h"
+#include "code_gen/trace.h"
+#include "code_gen/logging.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Private structs
+// Progress through a class declaration, from the keyword to its opening brace
+typedef enum class_head {
+    CLASS_HEAD_NONE,
+    CLASS_HEAD_KEYWORD, // Next identifier is the name
+    CLASS_HEAD_NAME,    // Name read, i.e. "class Player". Any following identifier (an export macro) replaces it
+    CLASS_HEAD_BASES,   // After ':', i.e. "class Player : public Node3D"
+} class_head_t;
+
+// Private functions
+static void unmap_text(generator_t* generator);
+static b8 close_class(generator_t* generator, int class_index);
+static b8 load_file(generator_t* generator, const char* input_path);
+static b8 parse_text(generator_t* generator, long file_length);
+static void count_parsed(const generator_t* generator);
+static char* append_extension(const char* path, const char* extension);
+
+// Function Impls
+void generator_init(generator_t* generator) {
+    memset(generator, 0, sizeof(generator_t));
+    arena_init(&generator->arena);
+    diagnostics_init(&generator->diagnostics);
+    output_buffer_init(&generator->output);
+    output_buffer_init(&generator->inline_output);
+}
+
+void generator_shutdown(generator_t* generator) {
+    unmap_text(generator);
+    arena_free(&generator->arena);
+    diagnostics_free(&generator->diagnostics);
+    output_buffer_free(&generator->output);
+    output_buffer_free(&generator->inline_output);
+    memset(generator, 0, sizeof(generator_t));
+}
+
+b8 generator_load_file(generator_t* generator, const char* input_path) {
+    trace_span_t span = trace_begin(TRACE_SPAN_READ);
+    b8 success = load_file(generator, input_path);
+    trace_count(TRACE_COUNTER_BYTES_IN, generator->text_length);
+    trace_end(span, input_path);
+    return success;
+}
+
+void generator_load_text(generator_t* generator, const char* text, long length) {
+    unmap_text(generator);
+    generator->text = length > 0 ? text : "";
+    generator->text_length = length > 0 ? length : 0;
+    trace_count(TRACE_COUNTER_BYTES_IN, generator->text_length);
+}
+
+b8 generator_may_have_exports(const generator_t* generator) {
+    trace_span_t span = trace_begin(TRACE_SPAN_PREFILTER);
+    b8 may_have_exports = memmem(generator->text, generator->text_length, "GD_EXPORT", sizeof("GD_EXPORT") - 1) != NULL ||
+        memmem(generator->text, generator->text_length, "_bind_methods", sizeof("_bind_methods") - 1) != NULL;
+    trace_end(span, NULL);
+    return may_have_exports;
+}
+
+b8 generator_parse(generator_t* generator, const char* input_path) {
+    trace_span_t span = trace_begin(TRACE_SPAN_PARSE);
+    diagnostics_begin(&generator->diagnostics, input_path, generator->text, generator->text_length);
+    b8 success = parse_text(generator, generator->text_length);
+    if (success && trace_active()) {
+        count_parsed(generator);
+    }
+    diagnostics_flush(&generator->diagnostics);
+    trace_end(span, input_path);
+    return success;
+}
+
+b8 generator_render(generator_t* generator, const char* input_path, const char** out_output, size_t* out_size) {
+    if (!generator_parse(generator, input_path)) {
+        *out_output = NULL;
+        *out_size = 0;
+        return false;
+    }
+
+    return generator_emit(generator, input_path, out_output, out_size);
+}
+
+b8 generator_emit(generator_t* generator, const char* source_path, const char** out_output, size_t* out_size) {
+    trace_span_t span = trace_begin(TRACE_SPAN_EMIT);
+
+    emit_options_t options = {
+        .inline_accessors = generator->write_inline,
+        .property_table = generator->property_table,
+    };
+
+    // The whole source is built in one buffer so it can be compared and written with a single call
+    output_buffer_reset(&generator->output);
+    for (int i = 0; i < generator->class_count; i++) {
+        if (!class_write_exports(&generator->classes[i], source_path, &options, &generator->output)) {
+            log_error("Failed to generate class '%s' from '%s'.", generator->classes[i].name, source_path);
+            trace_end(span, source_path);
+            *out_output = NULL;
+            *out_size = 0;
+            return false;
+        }
+    }
+
+    trace_count(TRACE_COUNTER_BYTES_OUT, generator->output.size);
+    trace_end(span, source_path);
+    *out_output = generator->output.data;
+    *out_size = generator->output.size;
+    return true;
+}
+
+b8 generator_write_ir(generator_t* generator, const char* source_path, const char* ir_path) {
+    output_buffer_t ir;
+    output_buffer_init(&ir);
+    ir_write(&ir, source_path, &generator->symbols.strings, generator->classes, generator->class_count);
+    b8 success = write_file_if_changed(ir_path, ir.data, ir.size, NULL);
+    output_buffer_free(&ir);
+    return success;
+}
+
+void generator_emit_inline(generator_t* generator, const char* source_path, const char** out_output, size_t* out_size) {
+    output_buffer_t* out = &generator->inline_output;
+    output_buffer_reset(out);
+    output_append_literal(out, "// Generated from \"");
+    output_append_string(out, source_path);
+    // Accessor types are written unqualified as in the header. The using-directive stays inside the namespace so
+    // translation units including the header don't get godot in the global scope
+    output_append_literal(out, "\". Include it at the end of that header, after its classes\n#pragma once\n\nnamespace wander {\nusing namespace godot;\n");
+    for (int i = 0; i < generator->class_count; i++) {
+        class_write_inline_accessors(&generator->classes[i], out);
+    }
+    output_append_literal(out, "}\n");
+
+    *out_output = out->data;
+    *out_size = out->size;
+}
+
+b8 generator_write_inline(generator_t* generator, const char* source_path, const char* output_path) {
+    const char* output = NULL;
+    size_t output_size = 0;
+    generator_emit_inline(generator, source_path, &output, &output_size);
+
+    char* inline_path = generator_inline_path(output_path);
+    b8 success = write_file_if_changed(inline_path, output, output_size, NULL);
+    free(inline_path);
+    return success;
+}
+
+char* generator_inline_path(const char* output_path) {
+    // Only an extension in the file name counts, not a '.' in a directory
+    const char* name = strrchr(output_path, '/');
+    const char* extension = strrchr(name ? name : output_path, '.');
+    size_t stem_length = extension ? (size_t)(extension - output_path) : strlen(output_path);
+
+    size_t length = stem_length + sizeof(INLINE_EXTENSION);
+    char* inline_path = malloc(length);
+    snprintf(inline_path, length, "%.*s%s", (int)stem_length, output_path, INLINE_EXTENSION);
+    return inline_path;
+}
+
+b8 generator_load_ir(generator_t* generator, const char* ir_path, const char** out_source_path) {
+    if (!generator_load_file(generator, ir_path)) {
+        return false;
+    }
+
+    arena_reset(&generator->arena);
+    generator->class_heirarchy = NULL;
+    generator->class_heirarchy_capacity = 0;
+    generator->class_capacity = 0;
+    if (!ir_read(generator->text, generator->text_length, &generator->arena, &generator->symbols, out_source_path, &generator->classes, &generator->class_count)) {
+        log_error("%s: Failed to load IR.", ir_path);
+        generator->classes = NULL;
+        generator->class_count = 0;
+        return false;
+    }
+    generator->class_capacity = generator->class_count;
+
+    return true;
+}
+
+b8 generator_process_file(generator_t* generator, const char* input_path, const char* output_path) {
+    trace_span_t span = trace_begin(TRACE_SPAN_FILE);
+    char* ir_path = generator->write_ir || generator->read_ir ? append_extension(output_path, IR_EXTENSION) : NULL;
+
+    // Render into memory so the output file is only touched when its contents change.
+    // Failed files are never written so the build doesn't pick up partially generated sources
+    const char* output = NULL;
+    size_t output_size = 0;
+    const char* source_path = input_path;
+    b8 success = false;
+    if (generator->read_ir) {
+        // The include has to match the original run, so the header path comes from the IR
+        success = generator_load_ir(generator, ir_path, &source_path) &&
+            generator_emit(generator, source_path, &output, &output_size);
+    } else {
+        success = generator_load_file(generator, input_path) &&
+            generator_render(generator, input_path, &output, &output_size) &&
+            (!generator->write_ir || generator_write_ir(generator, input_path, ir_path));
+    }
+
+    if (success) {
+        success = write_file_if_changed(output_path, output, output_size, NULL);
+    }
+    if (success && generator->write_inline) {
+        success = generator_write_inline(generator, source_path, output_path);
+    }
+
+    // Emitting from IR never reads the header, so the IR file is the only input
+    if (success && generator->write_depfile) {
+        const char* input = generator->read_ir ? ir_path : input_path;
+        char* inline_path = generator->write_inline ? generator_inline_path(output_path) : NULL;
+        const char* targets[3] = { output_path };
+        int target_count = 1;
+        if (inline_path) {
+            targets[target_count++] = inline_path;
+        }
+        if (generator->write_ir && !generator->read_ir) {
+            targets[target_count++] = ir_path;
+        }
+
+        char* depfile_path = generator->depfile_path ? NULL : append_extension(output_path, DEPFILE_EXTENSION);
+        success = depfile_write(generator->depfile_path ? generator->depfile_path : depfile_path, targets, target_count, &input, 1);
+        free(depfile_path);
+        free(inline_path);
+    }
+
+    unmap_text(generator);
+    free(ir_path);
+    trace_count(TRACE_COUNTER_FILES, 1);
+    trace_end(span, input_path ? input_path : output_path);
+    trace_sample_counters();
+    return success;
+}
+
+// Private functions
+static void unmap_text(generator_t* generator) {
+    if (generator->mapping) {
+        munmap(generator->mapping, generator->mapping_size);
+    }
+
+    generator->mapping = NULL;
+    generator->mapping_size = 0;
+    generator->text = NULL;
+    generator->text_length = 0;
+}
+
+static b8 load_file(generator_t* generator, const char* input_path) {
+    unmap_text(generator);
+
+    // Open file
+    int input_file = open(input_path, O_RDONLY);
+    if (input_file < 0) {
+        log_error("%s: Failed to open input file.", input_path);
+        return false;
+    }
+
+    // Get input file length
+    struct stat input_stat;
+    if (fstat(input_file, &input_stat) != 0 || !S_ISREG(input_stat.st_mode)) {
+        log_error("%s: Input is not a regular file.", input_path);
+        close(input_file);
+        return false;
+    }
+
+    // Empty files can't be mapped but are still valid input
+    if (input_stat.st_size == 0) {
+        close(input_file);
+        generator->text = "";
+        return true;
+    }
+
+    // Map the file so lines can be parsed in place without copying
+    void* mapping = mmap(NULL, input_stat.st_size, PROT_READ, MAP_PRIVATE, input_file, 0);
+    close(input_file);
+    if (mapping == MAP_FAILED) {
+        log_error("%s: Failed to map input file.", input_path);
+        return false;
+    }
+
+    generator->mapping = mapping;
+    generator->mapping_size = input_stat.st_size;
+    generator->text = mapping;
+    generator->text_length = input_stat.st_size;
+
+    return true;
+}
+
+static char* append_extension(const char* path, const char* extension) {
+    size_t length = strlen(path) + strlen(extension) + 1;
+    char* extended_path = malloc(length);
+    snprintf(extended_path, length, "%s%s", path, extension);
+    return extended_path;
+}
+
+// Parses every class in the text and resolves its exports. Classes are added to the generator as they close.
+// Errors are reported to the generator's diagnostics and parsing carries on, so the whole file is checked
+static b8 parse_text(generator_t* generator, long file_length) {
+    const char* text = generator->text;
+    class_t* class = NULL; // Innermost open class
+
+    // Everything parsed from the previous file is dropped at once
+    arena_reset(&generator->arena);
+    class_symbols_init(&generator->symbols, &generator->arena);
+    generator->class_heirarchy = NULL;
+    generator->class_heirarchy_capacity = 0;
+    generator->classes = NULL;
+    generator->class_count = 0;
+    generator->class_capacity = 0;
+
+    lexer_t lexer;
+    lexer_init(&lexer, text, file_length);
+
+    int class_index = -1;
+    int indent = 0;
+    long statement_count = 0;
+    b8 success = true;
+
+    // Only a head followed by '{' opens a class. Forward declarations, template parameters and
+    // elaborated type specifiers (i.e. "class Node* parent") never get one
+    class_head_t head = CLASS_HEAD_NONE;
+    token_t class_name = { 0 };
+    b8 after_enum = false;
+
+    // Between classes heads and markers only braces, ';' and a few keywords matter, so the rest is skimmed
+    token_t token;
+    while (head == CLASS_HEAD_NONE && !after_enum ? lexer_skim(&lexer, &token) : lexer_next_code(&lexer, &token)) {
+        if (token.kind == TOKEN_IDENTIFIER) {
+            if (token_equals(&lexer, &token, "class", 5)) {
+                head = after_enum ? CLASS_HEAD_NONE : CLASS_HEAD_KEYWORD;
+            } else if (head == CLASS_HEAD_KEYWORD || (head == CLASS_HEAD_NAME && !token_equals(&lexer, &token, "final", 5))) {
+                class_name = token;
+                head = CLASS_HEAD_NAME;
+            } else if (class_index >= 0 && token_equals(&lexer, &token, "_bind_methods", 13)) {
+                class->generate = 1;
+            }
+            after_enum = token_equals(&lexer, &token, "enum", 4);
+            continue;
+        }
+        after_enum = false;
+
+        // Markers are parsed in full, up to their closing parenthesis
+        if (token.kind == TOKEN_MARKER) {
+            head = CLASS_HEAD_NONE;
+            if (class_index < 0) {
+                diagnostics_warn(&generator->diagnostics, token.start, "'%.*s' outside of a class is ignored.", (int)token.length, text + token.start);
+            } else if (!class_parse_marker(class, &lexer, &token, &generator->diagnostics)) {
+                success = false;
+            }
+            continue;
+        }
+
+        if (token.kind != TOKEN_PUNCTUATION) {
+            continue;
+        }
+
+        const char c = text[token.start];
+        if (c == ':' && head == CLASS_HEAD_NAME) {
+            head = CLASS_HEAD_BASES;
+        } else if (c == '{') {
+            statement_count++;
+            if (head == CLASS_HEAD_NAME || head == CLASS_HEAD_BASES) {
+                class_index++;
+                if (class_index >= generator->class_heirarchy_capacity) {
+                    int capacity = generator->class_heirarchy_capacity ? generator->class_heirarchy_capacity * 2 : 8;
+                    generator->class_heirarchy = arena_grow(&generator->arena, generator->class_heirarchy,
+                            sizeof(class_scope_t) * generator->class_heirarchy_capacity, sizeof(class_scope_t) * capacity);
+                    generator->class_heirarchy_capacity = capacity;
+                }
+
+                class_scope_t* scope = &generator->class_heirarchy[class_index];
+                scope->indent = indent;
+                scope->span = trace_begin(TRACE_SPAN_CLASS);
+                class = &scope->class;
+                class_reset(class, &generator->arena, &generator->symbols);
+                class->name = arena_copy_string(&generator->arena, text + class_name.start, class_name.length);
+                log_trace("Found class '%s'", class->name);
+            }
+            head = CLASS_HEAD_NONE;
+            indent++;
+        } else if (c == '}') {
+            statement_count++;
+            head = CLASS_HEAD_NONE;
+            indent--;
+            if (class_index >= 0 && indent <= generator->class_heirarchy[class_index].indent) {
+                if (!close_class(generator, class_index)) {
+                    success = false;
+                }
+                class_index--;
+                class = class_index >= 0 ? &generator->class_heirarchy[class_index].class : NULL;
+            }
+        } else if (c == ';') {
+            statement_count++;
+            head = CLASS_HEAD_NONE;
+        } else if (head != CLASS_HEAD_BASES) {
+            // Anything else after the name means it wasn't a class definition, i.e. "template <class T>"
+            head = CLASS_HEAD_NONE;
+        }
+    }
+
+    trace_count(TRACE_COUNTER_LINES, statement_count);
+    return success;
+}
+
+// Resolves the exports of a class whose closing brace was just read and adds it to the generator's classes
+static b8 close_class(generator_t* generator, int class_index) {
+    class_t* class = &generator->class_heirarchy[class_index].class;
+    trace_span_t resolve_span = trace_begin(TRACE_SPAN_RESOLVE);
+    b8 resolved = class_resolve_exports(class, &generator->diagnostics);
+    trace_end(resolve_span, class->name);
+    trace_end(generator->class_heirarchy[class_index].span, class->name);
+    if (!resolved) {
+        return false;
+    }
+
+    if (generator->class_count >= generator->class_capacity) {
+        int capacity = generator->class_capacity ? generator->class_capacity * 2 : 8;
+        generator->classes = arena_grow(&generator->arena, generator->classes,
+                sizeof(class_t) * generator->class_capacity, sizeof(class_t) * capacity);
+        generator->class_capacity = capacity;
+    }
+    generator->classes[generator->class_count++] = *class;
+    return true;
+}
+
+static void count_parsed(const generator_t* generator) {
+    u64 export_count = 0;
+    u64 group_count = 0;
+    for (int i = 0; i < generator->class_count; i++) {
+        export_count += generator->classes[i].exports.count;
+        group_count += generator->classes[i].group_count + generator->classes[i].subgroup_count;
+    }
+
+    trace_count(TRACE_COUNTER_CLASSES, generator->class_count);
+    trace_count(TRACE_COUNTER_EXPORTS, export_count);
+    trace_count(TRACE_COUNTER_GROUPS, group_count);
+}
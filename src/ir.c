@@ -0,0 +1,297 @@
+#include "code_gen/ir.h"
+#include "code_gen/export_types.h"
+#include "code_gen/logging.h"
+
+#include <string.h>
+
+// Private structs
+typedef struct ir_header {
+    char magic[8];
+    u32 version;
+    u32 byte_order;
+    u32 source_path;
+    u32 class_count;
+    u32 export_count;
+    u32 group_count;
+    u32 string_count;
+    u32 string_size;
+} ir_header_t;
+
+typedef struct ir_class {
+    u32 name;
+    u32 generate;
+    u32 first_export;
+    u32 export_count;
+    u32 first_group;
+    u32 group_count;
+    u32 first_subgroup;
+    u32 subgroup_count;
+} ir_class_t;
+
+typedef struct ir_group {
+    u32 name;
+    u32 prefix;
+} ir_group_t;
+
+// Export columns of every class back to back, in the order they are stored
+typedef struct ir_exports {
+    const u32* names;
+    const u32* types;
+    const u32* callbacks;
+    const u32* hints;
+    const int* groups;
+    const int* subgroups;
+    const u8* notify;
+    const u8* flags;
+    const u8* export_types;
+} ir_exports_t;
+
+// Private data
+static const char ir_magic[8] = { 'G', 'D', 'C', 'G', 'I', 'R', 0, 0 };
+#define IR_BYTE_ORDER 0x01020304u
+
+// Byte columns are padded so the group records after them stay aligned
+#define IR_EXPORTS_SIZE(count) ((u64)(count) * (6 * sizeof(u32) + 3) + (4 - (u64)(count) * 3 % 4) % 4)
+
+// Private functions
+static void write_column(output_buffer_t* out, const class_t* classes, int class_count, size_t offset, size_t element_size);
+static void write_groups(output_buffer_t* out, string_table_t* strings, const group_t* groups, int group_count);
+static void read_groups(const ir_group_t* records, const string_table_t* strings, group_t* groups, int group_count);
+static b8 ids_valid(const u32* ids, size_t id_count, size_t stride, u32 string_count);
+static b8 exports_valid(const ir_exports_t* exports, const ir_class_t* record, const string_table_t* strings);
+
+// Function Impls
+void ir_write(output_buffer_t* out, const char* source_path, string_table_t* strings, const class_t* classes, int class_count) {
+    // The source path and class and group names are interned while the records are built, so the string table goes last
+    output_buffer_t records;
+    output_buffer_init(&records);
+
+    ir_header_t header = {
+        .version = IR_VERSION,
+        .byte_order = IR_BYTE_ORDER,
+        .source_path = string_table_intern(strings, source_path, strlen(source_path)),
+        .class_count = class_count,
+    };
+    memcpy(header.magic, ir_magic, sizeof(ir_magic));
+
+    for (int i = 0; i < class_count; i++) {
+        const class_t* class = &classes[i];
+        ir_class_t record = {
+            .name = string_table_intern(strings, class->name, strlen(class->name)),
+            .generate = class->generate,
+            .first_export = header.export_count,
+            .export_count = class->exports.count,
+            .first_group = header.group_count,
+            .group_count = class->group_count,
+            .first_subgroup = header.group_count + class->group_count,
+            .subgroup_count = class->subgroup_count,
+        };
+        header.export_count += class->exports.count;
+        header.group_count += class->group_count + class->subgroup_count;
+        output_append(&records, (const char*)&record, sizeof(record));
+    }
+
+    // The export table is written as it is stored, one column at a time
+    write_column(&records, classes, class_count, offsetof(export_table_t, names), sizeof(string_id_t));
+    write_column(&records, classes, class_count, offsetof(export_table_t, types), sizeof(string_id_t));
+    write_column(&records, classes, class_count, offsetof(export_table_t, callbacks), sizeof(string_id_t));
+    write_column(&records, classes, class_count, offsetof(export_table_t, hints), sizeof(string_id_t));
+    write_column(&records, classes, class_count, offsetof(export_table_t, groups), sizeof(int));
+    write_column(&records, classes, class_count, offsetof(export_table_t, subgroups), sizeof(int));
+    write_column(&records, classes, class_count, offsetof(export_table_t, notify), sizeof(u8));
+    write_column(&records, classes, class_count, offsetof(export_table_t, flags), sizeof(u8));
+    write_column(&records, classes, class_count, offsetof(export_table_t, export_types), sizeof(u8));
+    static const char padding[4] = { 0 };
+    output_append(&records, padding, (4 - header.export_count * 3 % 4) % 4);
+
+    for (int i = 0; i < class_count; i++) {
+        write_groups(&records, strings, classes[i].groups, classes[i].group_count);
+        write_groups(&records, strings, classes[i].subgroups, classes[i].subgroup_count);
+    }
+
+    output_buffer_t string_data;
+    output_buffer_init(&string_data);
+    string_table_write(strings, &string_data);
+    header.string_count = strings->count;
+    header.string_size = string_data.size;
+
+    output_append(out, (const char*)&header, sizeof(header));
+    output_append(out, records.data, records.size);
+    output_append(out, string_data.data, string_data.size);
+
+    output_buffer_free(&records);
+    output_buffer_free(&string_data);
+}
+
+b8 ir_read(const char* data, size_t size, arena_t* arena, class_symbols_t* symbols, const char** out_source_path, class_t** out_classes, int* out_class_count) {
+    ir_header_t header;
+    if (size < sizeof(header)) {
+        log_error("IR file is truncated.");
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    if (memcmp(header.magic, ir_magic, sizeof(ir_magic)) != 0) {
+        log_error("Not an IR file.");
+        return false;
+    }
+    if (header.version != IR_VERSION || header.byte_order != IR_BYTE_ORDER) {
+        log_error("IR file version %u is not supported (expected %u).", header.version, IR_VERSION);
+        return false;
+    }
+
+    // Sizes are checked in 64 bits so a corrupt count can't wrap around
+    u64 expected_size = sizeof(ir_header_t) +
+        (u64)header.class_count * sizeof(ir_class_t) +
+        IR_EXPORTS_SIZE(header.export_count) +
+        (u64)header.group_count * sizeof(ir_group_t) +
+        header.string_size;
+    if (expected_size != size) {
+        log_error("IR file size doesn't match its header.");
+        return false;
+    }
+
+    const ir_class_t* class_records = (const ir_class_t*)(data + sizeof(ir_header_t));
+    const u32 export_count = header.export_count;
+    const u32* id_columns = (const u32*)(class_records + header.class_count);
+    const u8* byte_columns = (const u8*)(id_columns + 6 * (u64)export_count);
+    const ir_exports_t exports = {
+        .names = id_columns,
+        .types = id_columns + export_count,
+        .callbacks = id_columns + 2 * (u64)export_count,
+        .hints = id_columns + 3 * (u64)export_count,
+        .groups = (const int*)(id_columns + 4 * (u64)export_count),
+        .subgroups = (const int*)(id_columns + 5 * (u64)export_count),
+        .notify = byte_columns,
+        .flags = byte_columns + export_count,
+        .export_types = byte_columns + 2 * (u64)export_count,
+    };
+    const ir_group_t* group_records = (const ir_group_t*)((const char*)id_columns + IR_EXPORTS_SIZE(export_count));
+    const char* string_data = (const char*)(group_records + header.group_count);
+
+    class_symbols_init(symbols, arena);
+    string_table_t* strings = &symbols->strings;
+    b8 valid = string_table_load(strings, string_data, header.string_size, header.string_count) &&
+        header.source_path < header.string_count &&
+        ids_valid(&class_records->name, header.class_count, sizeof(ir_class_t) / sizeof(u32), header.string_count) &&
+        ids_valid(exports.names, 4 * (u64)export_count, 1, header.string_count) &&
+        ids_valid(&group_records->name, 2 * (u64)header.group_count, 1, header.string_count);
+    for (u32 i = 0; valid && i < header.class_count; i++) {
+        const ir_class_t* record = &class_records[i];
+        valid = (u64)record->first_export + record->export_count <= export_count &&
+            (u64)record->first_group + record->group_count <= header.group_count &&
+            (u64)record->first_subgroup + record->subgroup_count <= header.group_count &&
+            exports_valid(&exports, record, strings);
+    }
+    if (!valid) {
+        log_error("IR file is corrupt.");
+        return false;
+    }
+
+    class_t* classes = arena_alloc(arena, sizeof(class_t) * header.class_count);
+    for (u32 i = 0; i < header.class_count; i++) {
+        const ir_class_t* record = &class_records[i];
+        class_t* class = &classes[i];
+        class_reset(class, arena, symbols);
+        class->name = string_table_get(strings, record->name);
+        class->generate = record->generate;
+
+        // Columns are copied as they are. A class without exports has no columns
+        const u32 first = record->first_export;
+        const u32 count = record->export_count;
+        export_table_t* table = &class->exports;
+        if (count > 0) {
+            class_reserve_exports(class, count);
+            table->count = count;
+            memcpy(table->names, exports.names + first, sizeof(string_id_t) * count);
+            memcpy(table->types, exports.types + first, sizeof(string_id_t) * count);
+            memcpy(table->callbacks, exports.callbacks + first, sizeof(string_id_t) * count);
+            memcpy(table->hints, exports.hints + first, sizeof(string_id_t) * count);
+            memcpy(table->groups, exports.groups + first, sizeof(int) * count);
+            memcpy(table->subgroups, exports.subgroups + first, sizeof(int) * count);
+            memcpy(table->notify, exports.notify + first, count);
+            memcpy(table->flags, exports.flags + first, count);
+            memcpy(table->export_types, exports.export_types + first, count);
+            memset(table->offsets, 0, sizeof(long) * count);
+        }
+
+        class->group_count = class->group_capacity = record->group_count;
+        class->groups = arena_alloc(arena, sizeof(group_t) * record->group_count);
+        read_groups(group_records + record->first_group, strings, class->groups, record->group_count);
+
+        class->subgroup_count = class->subgroup_capacity = record->subgroup_count;
+        class->subgroups = arena_alloc(arena, sizeof(group_t) * record->subgroup_count);
+        read_groups(group_records + record->first_subgroup, strings, class->subgroups, record->subgroup_count);
+    }
+
+    *out_source_path = string_table_get(strings, header.source_path);
+    *out_classes = classes;
+    *out_class_count = header.class_count;
+    return true;
+}
+
+// Private functions
+// Appends one column of every class's export table. offset is the column's offset in export_table_t
+static void write_column(output_buffer_t* out, const class_t* classes, int class_count, size_t offset, size_t element_size) {
+    for (int i = 0; i < class_count; i++) {
+        if (classes[i].exports.count > 0) {
+            const void* column = *(const void* const*)((const char*)&classes[i].exports + offset);
+            output_append(out, column, element_size * classes[i].exports.count);
+        }
+    }
+}
+
+static void write_groups(output_buffer_t* out, string_table_t* strings, const group_t* groups, int group_count) {
+    for (int i = 0; i < group_count; i++) {
+        ir_group_t record = {
+            .name = string_table_intern(strings, groups[i].name, strlen(groups[i].name)),
+            .prefix = string_table_intern(strings, groups[i].prefix, strlen(groups[i].prefix)),
+        };
+        output_append(out, (const char*)&record, sizeof(record));
+    }
+}
+
+static void read_groups(const ir_group_t* records, const string_table_t* strings, group_t* groups, int group_count) {
+    for (int i = 0; i < group_count; i++) {
+        groups[i] = (group_t) {
+            .name = string_table_get(strings, records[i].name),
+            .prefix = string_table_get(strings, records[i].prefix),
+        };
+    }
+}
+
+// Checks string ids in an array of records. stride is the record size in u32s
+static b8 ids_valid(const u32* ids, size_t id_count, size_t stride, u32 string_count) {
+    for (size_t i = 0; i < id_count; i++) {
+        if (ids[i * stride] >= string_count) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Checks the exports of one class. Group indices must not decrease, since groups are written before their first export
+static b8 exports_valid(const ir_exports_t* exports, const ir_class_t* record, const string_table_t* strings) {
+    int group = -1;
+    int subgroup = -1;
+    for (u32 i = record->first_export; i < record->first_export + record->export_count; i++) {
+        const u8 export_type = exports->export_types[i];
+        const u8 notify = exports->notify[i];
+        const u8 flags = exports->flags[i];
+        if (export_type == EXPORT_TYPE_NULL || export_type > EXPORT_TYPE_PACKED_VECTOR4_ARRAY ||
+                notify > EXPORT_NOTIFY_DEFERRED ||
+                (notify != EXPORT_NOTIFY_NONE && strings->entries[exports->callbacks[i]].length == 0) ||
+                (flags & ~(EXPORT_TYPE_FLAGS | EXPORT_FLAG_PACKED_ACCESSORS)) != 0 ||
+                ((flags & EXPORT_FLAG_PACKED_ACCESSORS) && !export_types_packed_element(export_type)) ||
+                exports->groups[i] < group || exports->groups[i] >= (int)record->group_count ||
+                exports->subgroups[i] < subgroup || exports->subgroups[i] >= (int)record->subgroup_count) {
+            return false;
+        }
+
+        group = exports->groups[i];
+        subgroup = exports->subgroups[i];
+    }
+
+    return true;
+}
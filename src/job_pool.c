@@ -0,0 +1,154 @@
+#include "code_gen/job_pool.h"
+#include "code_gen/logging.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Private structs
+typedef struct job_queue {
+    pthread_mutex_t lock;
+    int* jobs;
+    int head; // Owner takes jobs from the head
+    int tail; // Thieves take jobs from the tail
+} job_queue_t;
+
+typedef struct job_pool {
+    job_queue_t* queues;
+    int worker_count;
+    job_func_t func;
+    void* user_data;
+    int failed_count;
+    pthread_mutex_t failed_lock;
+} job_pool_t;
+
+typedef struct job_worker {
+    job_pool_t* pool;
+    int index;
+} job_worker_t;
+
+// Private functions
+static b8 queue_pop(job_queue_t* queue, int* out_job);
+static b8 queue_steal(job_queue_t* queue, int* out_job);
+static void* worker_main(void* data);
+
+// Function Impls
+int job_pool_run(int worker_count, int job_count, job_func_t func, void* user_data) {
+    if (worker_count > job_count) {
+        worker_count = job_count;
+    }
+    if (worker_count < 1) {
+        worker_count = 1;
+    }
+
+    job_pool_t pool = {
+        .worker_count = worker_count,
+        .func = func,
+        .user_data = user_data,
+    };
+    pthread_mutex_init(&pool.failed_lock, NULL);
+
+    // Deal jobs round-robin so every worker starts with a share of the expensive ones
+    pool.queues = calloc(worker_count, sizeof(job_queue_t));
+    for (int i = 0; i < worker_count; i++) {
+        job_queue_t* queue = &pool.queues[i];
+        pthread_mutex_init(&queue->lock, NULL);
+        queue->jobs = malloc(sizeof(int) * (job_count / worker_count + 1));
+    }
+    for (int i = 0; i < job_count; i++) {
+        job_queue_t* queue = &pool.queues[i % worker_count];
+        queue->jobs[queue->tail++] = i;
+    }
+
+    // Worker 0 runs on the calling thread
+    job_worker_t* workers = calloc(worker_count, sizeof(job_worker_t));
+    pthread_t* threads = calloc(worker_count, sizeof(pthread_t));
+    for (int i = 0; i < worker_count; i++) {
+        workers[i] = (job_worker_t) { .pool = &pool, .index = i };
+    }
+    int started_count = 1;
+    for (int i = 1; i < worker_count; i++) {
+        if (pthread_create(&threads[i], NULL, worker_main, &workers[i]) != 0) {
+            // Remaining queues are drained by stealing
+            log_warn("Failed to start worker thread %d.", i);
+            break;
+        }
+        started_count++;
+    }
+
+    worker_main(&workers[0]);
+    for (int i = 1; i < started_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // Cleanup
+    for (int i = 0; i < worker_count; i++) {
+        pthread_mutex_destroy(&pool.queues[i].lock);
+        free(pool.queues[i].jobs);
+    }
+    free(pool.queues);
+    free(workers);
+    free(threads);
+    pthread_mutex_destroy(&pool.failed_lock);
+
+    return pool.failed_count;
+}
+
+int job_pool_default_worker_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+// Private functions
+static b8 queue_pop(job_queue_t* queue, int* out_job) {
+    pthread_mutex_lock(&queue->lock);
+    b8 found = queue->head < queue->tail;
+    if (found) {
+        *out_job = queue->jobs[queue->head++];
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return found;
+}
+
+static b8 queue_steal(job_queue_t* queue, int* out_job) {
+    pthread_mutex_lock(&queue->lock);
+    b8 found = queue->head < queue->tail;
+    if (found) {
+        *out_job = queue->jobs[--queue->tail];
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return found;
+}
+
+static void* worker_main(void* data) {
+    job_worker_t* worker = data;
+    job_pool_t* pool = worker->pool;
+
+    while (true) {
+        // Drain own queue first, then try every other worker once before giving up.
+        // Jobs are never added after startup so an empty sweep means all work is claimed.
+        int job = -1;
+        if (!queue_pop(&pool->queues[worker->index], &job)) {
+            for (int i = 1; i < pool->worker_count; i++) {
+                int victim = (worker->index + i) % pool->worker_count;
+                if (queue_steal(&pool->queues[victim], &job)) {
+                    break;
+                }
+            }
+        }
+        if (job < 0) {
+            break;
+        }
+
+        if (!pool->func(pool->user_data, worker->index, job)) {
+            pthread_mutex_lock(&pool->failed_lock);
+            pool->failed_count++;
+            pthread_mutex_unlock(&pool->failed_lock);
+        }
+    }
+
+    // Buffered messages are per thread and would be lost when the thread exits
+    log_flush();
+    return NULL;
+}
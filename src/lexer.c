@@ -0,0 +1,304 @@
+#include "code_gen/lexer.h"
+#include "code_gen/scanner.h"
+
+#include <pthread.h>
+#include <string.h>
+
+// Private data
+// Every byte maps to one of these, the DFA only ever looks at the class
+enum char_class {
+    CHAR_OTHER,     // Punctuation and control characters
+    CHAR_SPACE,
+    CHAR_NEWLINE,
+    CHAR_LETTER,    // Letters, '_' and any byte of a UTF-8 sequence
+    CHAR_DIGIT,
+    CHAR_DOT,
+    CHAR_SLASH,
+    CHAR_STAR,
+    CHAR_QUOTE,
+    CHAR_APOSTROPHE,
+    CHAR_BACKSLASH,
+    CHAR_HASH,
+    CHAR_CLASS_COUNT,
+};
+
+// LEX_DONE is 0 so that a token ends on any transition not listed
+enum lex_state {
+    LEX_DONE,
+    LEX_START,
+    LEX_SPACE,
+    LEX_IDENTIFIER,
+    LEX_NUMBER,
+    LEX_PUNCTUATION,
+    LEX_SLASH,         // Division or the start of a comment
+    LEX_LINE_COMMENT,
+    LEX_BLOCK_COMMENT,
+    LEX_BLOCK_STAR,    // '*' inside a block comment, which may close it
+    LEX_BLOCK_END,
+    LEX_STRING,
+    LEX_STRING_ESCAPE,
+    LEX_LITERAL_END,   // Closing quote of a string or character literal
+    LEX_CHAR,
+    LEX_CHAR_ESCAPE,
+    LEX_DIRECTIVE,
+    LEX_DIRECTIVE_ESCAPE, // Backslash in a directive, a newline after it continues the directive
+    LEX_STATE_COUNT,
+};
+
+// Anything not listed is CHAR_OTHER
+static const u8 char_classes[256] = {
+    [' '] = CHAR_SPACE, ['\t'] = CHAR_SPACE, ['\r'] = CHAR_SPACE, ['\v'] = CHAR_SPACE, ['\f'] = CHAR_SPACE,
+    ['\n'] = CHAR_NEWLINE,
+    ['a' ... 'z'] = CHAR_LETTER, ['A' ... 'Z'] = CHAR_LETTER, ['_'] = CHAR_LETTER, [0x80 ... 0xFF] = CHAR_LETTER,
+    ['0' ... '9'] = CHAR_DIGIT,
+    ['.'] = CHAR_DOT,
+    ['/'] = CHAR_SLASH,
+    ['*'] = CHAR_STAR,
+    ['"'] = CHAR_QUOTE,
+    ['\''] = CHAR_APOSTROPHE,
+    ['\\'] = CHAR_BACKSLASH,
+    ['#'] = CHAR_HASH,
+};
+
+#define O  LEX_DONE
+#define SP LEX_SPACE
+#define ID LEX_IDENTIFIER
+#define NU LEX_NUMBER
+#define PU LEX_PUNCTUATION
+#define SL LEX_SLASH
+#define LC LEX_LINE_COMMENT
+#define BC LEX_BLOCK_COMMENT
+#define BS LEX_BLOCK_STAR
+#define BE LEX_BLOCK_END
+#define SR LEX_STRING
+#define SE LEX_STRING_ESCAPE
+#define LE LEX_LITERAL_END
+#define CH LEX_CHAR
+#define CE LEX_CHAR_ESCAPE
+#define DI LEX_DIRECTIVE
+#define DE LEX_DIRECTIVE_ESCAPE
+
+static const u8 transitions[LEX_STATE_COUNT][CHAR_CLASS_COUNT] = {
+    //                    other space newline letter digit dot slash star quote  '    \    #
+    [LEX_DONE]         = { O,    O,    O,      O,     O,    O,  O,    O,   O,    O,   O,   O  },
+    [LEX_START]        = { PU,   SP,   SP,     ID,    NU,   PU, SL,   PU,  SR,   CH,  PU,  DI },
+    [LEX_SPACE]        = { O,    SP,   SP,     O,     O,    O,  O,    O,   O,    O,   O,   O  },
+    [LEX_IDENTIFIER]   = { O,    O,    O,      ID,    ID,   O,  O,    O,   O,    O,   O,   O  },
+    [LEX_NUMBER]       = { O,    O,    O,      NU,    NU,   NU, O,    O,   O,    NU,  O,   O  },
+    [LEX_PUNCTUATION]  = { O,    O,    O,      O,     O,    O,  O,    O,   O,    O,   O,   O  },
+    [LEX_SLASH]        = { O,    O,    O,      O,     O,    O,  LC,   BC,  O,    O,   O,   O  },
+    [LEX_LINE_COMMENT] = { LC,   LC,   O,      LC,    LC,   LC, LC,   LC,  LC,   LC,  LC,  LC },
+    [LEX_BLOCK_COMMENT]= { BC,   BC,   BC,     BC,    BC,   BC, BC,   BS,  BC,   BC,  BC,  BC },
+    [LEX_BLOCK_STAR]   = { BC,   BC,   BC,     BC,    BC,   BC, BE,   BS,  BC,   BC,  BC,  BC },
+    [LEX_BLOCK_END]    = { O,    O,    O,      O,     O,    O,  O,    O,   O,    O,   O,   O  },
+    [LEX_STRING]       = { SR,   SR,   O,      SR,    SR,   SR, SR,   SR,  LE,   SR,  SE,  SR },
+    [LEX_STRING_ESCAPE]= { SR,   SR,   SR,     SR,    SR,   SR, SR,   SR,  SR,   SR,  SR,  SR },
+    [LEX_LITERAL_END]  = { O,    O,    O,      O,     O,    O,  O,    O,   O,    O,   O,   O  },
+    [LEX_CHAR]         = { CH,   CH,   O,      CH,    CH,   CH, CH,   CH,  CH,   LE,  CE,  CH },
+    [LEX_CHAR_ESCAPE]  = { CH,   CH,   CH,     CH,    CH,   CH, CH,   CH,  CH,   CH,  CH,  CH },
+    [LEX_DIRECTIVE]    = { DI,   DI,   O,      DI,    DI,   DI, DI,   DI,  DI,   DI,  DE,  DI },
+    [LEX_DIRECTIVE_ESCAPE] = { DI, DE, DI,     DI,    DI,   DI, DI,   DI,  DI,   DI,  DE,  DI },
+};
+
+#undef O
+#undef SP
+#undef ID
+#undef NU
+#undef PU
+#undef SL
+#undef LC
+#undef BC
+#undef BS
+#undef BE
+#undef SR
+#undef SE
+#undef LE
+#undef CH
+#undef CE
+#undef DI
+#undef DE
+
+// The token a state produces when the next character has no transition. Whitespace produces TOKEN_END and is skipped.
+// Unterminated comments and literals still end at the end of the text (or line) as whole tokens
+static const token_kind_t state_tokens[LEX_STATE_COUNT] = {
+    [LEX_IDENTIFIER] = TOKEN_IDENTIFIER,
+    [LEX_NUMBER] = TOKEN_NUMBER,
+    [LEX_PUNCTUATION] = TOKEN_PUNCTUATION,
+    [LEX_SLASH] = TOKEN_PUNCTUATION,
+    [LEX_LINE_COMMENT] = TOKEN_COMMENT,
+    [LEX_BLOCK_COMMENT] = TOKEN_COMMENT,
+    [LEX_BLOCK_STAR] = TOKEN_COMMENT,
+    [LEX_BLOCK_END] = TOKEN_COMMENT,
+    [LEX_STRING] = TOKEN_STRING,
+    [LEX_STRING_ESCAPE] = TOKEN_STRING,
+    [LEX_LITERAL_END] = TOKEN_STRING,
+    [LEX_CHAR] = TOKEN_STRING,
+    [LEX_CHAR_ESCAPE] = TOKEN_STRING,
+    [LEX_DIRECTIVE] = TOKEN_DIRECTIVE,
+    [LEX_DIRECTIVE_ESCAPE] = TOKEN_DIRECTIVE,
+};
+
+typedef struct marker_name {
+    token_marker_t marker;
+    const char* name;
+    long length;
+} marker_name_t;
+
+static const marker_name_t marker_names[] = {
+    { TOKEN_MARKER_EXPORT, "GD_EXPORT", sizeof("GD_EXPORT") - 1 },
+    { TOKEN_MARKER_EXPORT_NOTIFY, "GD_EXPORT_NOTIFY", sizeof("GD_EXPORT_NOTIFY") - 1 },
+    { TOKEN_MARKER_EXPORT_NOTIFY_DEFERRED, "GD_EXPORT_NOTIFY_DEFERRED", sizeof("GD_EXPORT_NOTIFY_DEFERRED") - 1 },
+    { TOKEN_MARKER_EXPORT_PACKED, "GD_EXPORT_PACKED", sizeof("GD_EXPORT_PACKED") - 1 },
+    { TOKEN_MARKER_GROUP, "GD_GROUP", sizeof("GD_GROUP") - 1 },
+    { TOKEN_MARKER_SUBGROUP, "GD_SUBGROUP", sizeof("GD_SUBGROUP") - 1 },
+};
+static const int marker_name_count = sizeof(marker_names) / sizeof(marker_name_t);
+
+// transitions with the character class lookup folded in, so the DFA takes one load per byte. Built once from the tables above
+static u8 byte_transitions[LEX_STATE_COUNT][256];
+static pthread_once_t byte_transitions_once = PTHREAD_ONCE_INIT;
+
+// Private functions
+static void build_byte_transitions(void);
+static long skip_run(const char* text, long position, long length, u8 state);
+static b8 continues_token(u8 c);
+static token_marker_t find_marker(const char* text, long length);
+
+// Function Impls
+void lexer_init(lexer_t* lexer, const char* text, long length) {
+    pthread_once(&byte_transitions_once, build_byte_transitions);
+    lexer->text = text;
+    lexer->length = length;
+    lexer->position = 0;
+}
+
+b8 lexer_next(lexer_t* lexer, token_t* out_token) {
+    const char* text = lexer->text;
+    const long length = lexer->length;
+    long position = lexer->position;
+
+    while (position < length) {
+        const long start = position;
+        u8 state = LEX_START;
+        while (position < length) {
+            const u8 next = byte_transitions[state][(u8)text[position]];
+            if (next == LEX_DONE) {
+                break;
+            }
+            position++;
+
+            // Most bytes belong to states that loop on themselves (identifiers, whitespace, comment bodies)
+            if (next == state) {
+                position = skip_run(text, position, length, state);
+            }
+            state = next;
+        }
+
+        const token_kind_t kind = state_tokens[state];
+        if (kind == TOKEN_END) {
+            continue;
+        }
+
+        *out_token = (token_t) { .kind = kind, .marker = TOKEN_MARKER_NONE, .start = start, .length = position - start };
+        if (kind == TOKEN_IDENTIFIER && position - start >= 8 && text[start] == 'G' && text[start + 1] == 'D' && text[start + 2] == '_') {
+            out_token->marker = find_marker(text + start, position - start);
+            out_token->kind = out_token->marker != TOKEN_MARKER_NONE ? TOKEN_MARKER : TOKEN_IDENTIFIER;
+        }
+        lexer->position = position;
+        return true;
+    }
+
+    lexer->position = position;
+    *out_token = (token_t) { .kind = TOKEN_END, .start = position, };
+    return false;
+}
+
+b8 lexer_next_code(lexer_t* lexer, token_t* out_token) {
+    while (lexer_next(lexer, out_token)) {
+        if (out_token->kind != TOKEN_COMMENT && out_token->kind != TOKEN_DIRECTIVE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+b8 lexer_skim(lexer_t* lexer, token_t* out_token) {
+    const char* text = lexer->text;
+    const long candidate = scanner_find_candidate(text, lexer->position, lexer->length);
+
+    // Braces and ';' are most candidates and always a token of their own
+    if (candidate < lexer->length && (text[candidate] == '{' || text[candidate] == '}' || text[candidate] == ';')) {
+        *out_token = (token_t) { .kind = TOKEN_PUNCTUATION, .marker = TOKEN_MARKER_NONE, .start = candidate, .length = 1 };
+        lexer->position = candidate + 1;
+        return true;
+    }
+
+    // Everything skipped is plain code, no comment or literal starts in it. A candidate inside an identifier or
+    // number (i.e. "subclass" or 1'000) isn't a token start, lexing resumes where the run it belongs to starts
+    long start = candidate;
+    while (start > lexer->position && continues_token((u8)text[start - 1])) {
+        start--;
+    }
+
+    lexer->position = start;
+    return lexer_next_code(lexer, out_token);
+}
+
+b8 token_is(const lexer_t* lexer, const token_t* token, char c) {
+    return token->kind == TOKEN_PUNCTUATION && lexer->text[token->start] == c;
+}
+
+b8 token_equals(const lexer_t* lexer, const token_t* token, const char* string, long length) {
+    return token->length == length && memcmp(lexer->text + token->start, string, length) == 0;
+}
+
+// Private functions
+static void build_byte_transitions(void) {
+    for (int state = 0; state < LEX_STATE_COUNT; state++) {
+        for (int c = 0; c < 256; c++) {
+            byte_transitions[state][c] = transitions[state][char_classes[c]];
+        }
+    }
+}
+
+// Returns where a state that loops on itself ends. States that only a few bytes leave are searched a block at a
+// time, the rest don't need the state from the previous byte, so each lookup no longer waits on the last one
+static long skip_run(const char* text, long position, long length, u8 state) {
+    switch (state) {
+        case LEX_SPACE:
+            return scanner_skip_space(text, position, length);
+        case LEX_LINE_COMMENT:
+            return scanner_find_any(text, position, length, '\n', '\n', '\n');
+        case LEX_BLOCK_COMMENT:
+            return scanner_find_any(text, position, length, '*', '*', '*');
+        case LEX_STRING:
+            return scanner_find_any(text, position, length, '"', '\\', '\n');
+        case LEX_CHAR:
+            return scanner_find_any(text, position, length, '\'', '\\', '\n');
+        case LEX_DIRECTIVE:
+            return scanner_find_any(text, position, length, '\n', '\\', '\\');
+        default:
+            break;
+    }
+
+    const u8* row = byte_transitions[state];
+    while (position < length && row[(u8)text[position]] == state) {
+        position++;
+    }
+    return position;
+}
+
+// Bytes that can be part of an identifier or number after its first byte
+static b8 continues_token(u8 c) {
+    const u8 char_class = char_classes[c];
+    return char_class == CHAR_LETTER || char_class == CHAR_DIGIT || char_class == CHAR_DOT;
+}
+
+static token_marker_t find_marker(const char* text, long length) {
+    for (int i = 0; i < marker_name_count; i++) {
+        if (marker_names[i].length == length && memcmp(marker_names[i].name, text, length) == 0) {
+            return marker_names[i].marker;
+        }
+    }
+    return TOKEN_MARKER_NONE;
+}
@@ -0,0 +1,186 @@
+#include "code_gen/logging.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// Private data
+#define LOG_BUFFER_SIZE 8192
+
+static const char* level_names[6] = { "debug", "trace", "info", "warn", "error", "fatal", };
+static const char* level_strings[6] = {
+    "[DEBUG]: ",
+    "[TRACE]: ",
+    "[INFO]:  ",
+    "[WARN]:  ",
+    "[ERROR]: ",
+    "[FATAL]: ",
+};
+static const char* level_colors[6] = {
+    "\x1B[32m",
+    "\x1B[36m",
+    "\x1B[37m",
+    "\x1B[33m",
+    "\x1B[91m",
+    "\x1B[31m",
+};
+static const char* color_reset = "\x1B[0m";
+
+static enum log_level runtime_level = LOG_LEVEL_INFO;
+static b8 use_color = false;
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+
+static _Thread_local char buffer[LOG_BUFFER_SIZE];
+static _Thread_local size_t buffer_size = 0;
+static _Thread_local log_capture_t* capture = NULL;
+
+// Private functions
+static void init(void);
+static void write_all(const char* data, size_t size);
+static void append(const char* data, size_t size);
+static void capture_message(enum log_level level, const char* format, va_list args);
+
+// Function Impls
+void log_set_level(enum log_level level) {
+    runtime_level = level;
+}
+
+b8 log_level_enabled(enum log_level level) {
+    return level >= runtime_level;
+}
+
+b8 log_parse_level(const char* name, enum log_level* out_level) {
+    for (int i = 0; i < (int)(sizeof(level_names) / sizeof(const char*)); i++) {
+        if (strcmp(name, level_names[i]) == 0) {
+            *out_level = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void log_set_capture(log_capture_t* new_capture) {
+    capture = new_capture;
+}
+
+void log_write(enum log_level level, const char* format, ...) {
+    if (capture && level != LOG_LEVEL_FATAL) {
+        va_list args;
+        va_start(args, format);
+        capture_message(level, format, args);
+        va_end(args);
+        return;
+    }
+
+    pthread_once(&init_once, init);
+
+    if (use_color) {
+        append(level_colors[level], strlen(level_colors[level]));
+    }
+    append(level_strings[level], strlen(level_strings[level]));
+
+    // Formatted straight into the buffer when it fits, which is nearly always
+    va_list args;
+    va_start(args, format);
+    size_t available = LOG_BUFFER_SIZE - buffer_size;
+    int length = vsnprintf(buffer + buffer_size, available, format, args);
+    va_end(args);
+    if (length > 0 && (size_t)length < available) {
+        buffer_size += length;
+    } else if (length > 0) {
+        char* message = malloc(length + 1);
+        if (message) {
+            va_start(args, format);
+            vsnprintf(message, length + 1, format, args);
+            va_end(args);
+            append(message, length);
+            free(message);
+        }
+    }
+
+    if (use_color) {
+        append(color_reset, strlen(color_reset));
+    }
+    append("\n", 1);
+
+    if (level >= LOG_LEVEL_INFO) {
+        log_flush();
+    }
+}
+
+void log_flush(void) {
+    write_all(buffer, buffer_size);
+    buffer_size = 0;
+}
+
+// Private functions
+static void init(void) {
+    use_color = isatty(STDOUT_FILENO);
+    atexit(log_flush);
+}
+
+static void write_all(const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(STDOUT_FILENO, data, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return;
+        }
+
+        data += written;
+        size -= written;
+    }
+}
+
+static void append(const char* data, size_t size) {
+    if (buffer_size + size > LOG_BUFFER_SIZE) {
+        log_flush();
+    }
+
+    // Anything larger than the buffer is written straight through
+    if (size > LOG_BUFFER_SIZE) {
+        write_all(data, size);
+        return;
+    }
+
+    memcpy(buffer + buffer_size, data, size);
+    buffer_size += size;
+}
+
+static void capture_message(enum log_level level, const char* format, va_list args) {
+    if (level < LOG_LEVEL_WARN) {
+        return;
+    }
+
+    if (level == LOG_LEVEL_ERROR) {
+        capture->error_count++;
+    } else {
+        capture->warning_count++;
+    }
+    if (!capture->messages) {
+        return;
+    }
+
+    if (capture->path) {
+        output_append_string(capture->messages, capture->path);
+        output_append_literal(capture->messages, ": ");
+    }
+    if (level == LOG_LEVEL_ERROR) {
+        output_append_literal(capture->messages, "error: ");
+    } else {
+        output_append_literal(capture->messages, "warning: ");
+    }
+
+    char message[LOG_BUFFER_SIZE];
+    int length = vsnprintf(message, sizeof(message), format, args);
+    if (length > 0) {
+        output_append(capture->messages, message, (size_t)length < sizeof(message) ? (size_t)length : sizeof(message) - 1);
+    }
+    output_append_literal(capture->messages, "\n");
+}
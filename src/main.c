@@ -2,149 +2,437 @@
 #include <string.h>
 #include <stdio.h>
 
+#include <sys/stat.h>
+
 #include "code_gen/defines.h"
-#include "code_gen/class_parser.h"
-#include "code_gen/string_utils.h"
+#include "code_gen/depfile.h"
+#include "code_gen/diagnostics.h"
+#include "code_gen/export_types.h"
+#include "code_gen/generator.h"
+#include "code_gen/job_pool.h"
+#include "code_gen/logging.h"
+#include "code_gen/scan.h"
+#include "code_gen/server.h"
+#include "code_gen/trace.h"
+
+// Private structs
+// Settings for file and batch mode
+typedef struct run_options {
+    const char* filename;
+    const char* output_path;
+    const char* manifest_path;
+    const char* socket_path;
+    const char* depfile_path;
+    int worker_count;
+    b8 write_ir;
+    b8 read_ir;
+    b8 write_depfile;
+    b8 write_inline;
+    b8 property_table;
+    b8 use_server;
+} run_options_t;
+
+typedef struct batch_entry {
+    const char* input_path;
+    const char* output_path;
+    long size;
+} batch_entry_t;
 
-// Private data
-const char* line_ends[] = { ";", "{", "}", "public:", "private:", "protected:", };
-const int line_end_count = sizeof(line_ends) / sizeof(const char*);
+typedef struct batch {
+    batch_entry_t* entries;
+    int entry_count;
+    int entry_capacity;
+    generator_t* generators; // One per worker
+} batch_t;
+
+// Private functions
+static int run(const run_options_t* options);
+static int run_batch(const run_options_t* options);
+static void apply_options(generator_t* generator, const run_options_t* options);
+static b8 run_batch_entry(void* user_data, int worker_index, int job_index);
+static int compare_entry_size(const void* a, const void* b);
+static char* read_manifest_path(char** cursor);
+static b8 write_request_depfile(const char* depfile_path, const char* input_path, const char* output_path);
 
 int main(int argc, char** argv) {
     // Search args for input and output files
     const char* filename = NULL;
     const char* output_path = NULL;
+    const char* manifest_path = NULL;
+    const char* serve_path = NULL;
+    const char* socket_path = getenv(SERVER_SOCKET_ENV);
+    int worker_count = job_pool_default_worker_count();
+    const char* scan_path = NULL;
+    const char* list_path = NULL;
+    const char** filters = calloc(argc, sizeof(const char*));
+    int filter_count = 0;
+    int unity_count = 0;
+    long unity_bytes = 0;
+    b8 write_ir = false;
+    b8 read_ir = false;
+    b8 write_depfile = false;
+    b8 write_inline = false;
+    b8 property_table = false;
+    b8 has_aliases = false;
+    b8 has_log_level = false;
+    const char* depfile_path = NULL;
+    const char* trace_path = NULL;
     for (int i = 0; i < argc; i++) {
-        if (strcmp(argv[i], "-o") == 0) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
             output_path = argv[i + 1];
             i++;
         }
-        if (strcmp(argv[i], "file") == 0) {
+        else if (strcmp(argv[i], "file") == 0 && i + 1 < argc) {
             filename = argv[i + 1];
             i++;
         }
+        else if (strcmp(argv[i], "batch") == 0 && i + 1 < argc) {
+            manifest_path = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "scan") == 0 && i + 1 < argc) {
+            scan_path = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filters[filter_count++] = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "--list") == 0 && i + 1 < argc) {
+            list_path = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "--alias") == 0 && i + 1 < argc) {
+            // Registered before any workers start since the type table isn't locked
+            if (!export_types_register_alias_pair(argv[i + 1])) {
+                free(filters);
+                return -1;
+            }
+            has_aliases = true;
+            i++;
+        }
+        else if (strcmp(argv[i], "--unity") == 0 && i + 1 < argc) {
+            unity_count = atoi(argv[i + 1]);
+            i++;
+        }
+        else if (strcmp(argv[i], "--unity-bytes") == 0 && i + 1 < argc) {
+            unity_bytes = atol(argv[i + 1]);
+            i++;
+        }
+        else if (strcmp(argv[i], "-MD") == 0) {
+            write_depfile = true;
+        }
+        else if (strcmp(argv[i], "--depfile") == 0 && i + 1 < argc) {
+            write_depfile = true;
+            depfile_path = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "--ir") == 0) {
+            write_ir = true;
+        }
+        else if (strcmp(argv[i], "--from-ir") == 0) {
+            read_ir = true;
+        }
+        else if (strcmp(argv[i], "--inline") == 0) {
+            write_inline = true;
+        }
+        else if (strcmp(argv[i], "--property-table") == 0) {
+            property_table = true;
+        }
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            worker_count = atoi(argv[i + 1]);
+            i++;
+        }
+        else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            serve_path = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            socket_path = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            enum log_level level;
+            if (!log_parse_level(argv[i + 1], &level)) {
+                log_error("Unknown log level '%s'. Expected debug, trace, info, warn, error or fatal.", argv[i + 1]);
+                free(filters);
+                return -1;
+            }
+            log_set_level(level);
+            has_log_level = true;
+            i++;
+        }
+        else if (argv[i][0] == '@' && argv[i][1] != 0) {
+            manifest_path = argv[i] + 1;
+        }
+    }
+
+    if (serve_path != NULL) {
+        free(filters);
+        return server_run(serve_path);
+    }
+
+    // Started before any workers, which register with the trace as they record their first span
+    if (trace_path != NULL && !trace_start(trace_path)) {
+        free(filters);
+        return -1;
+    }
+
+    if (scan_path != NULL) {
+        if (output_path == NULL) {
+            log_error("Scan mode requires an output directory (-o).");
+            free(filters);
+            return -1;
+        }
+
+        scan_options_t options = {
+            .root_path = scan_path,
+            .output_path = output_path,
+            .list_path = list_path,
+            .filters = filters,
+            .filter_count = filter_count,
+            .worker_count = worker_count,
+            .unity_count = unity_count,
+            .unity_bytes = unity_bytes,
+            .write_ir = write_ir,
+            .write_depfile = write_depfile,
+            .write_inline = write_inline,
+            .property_table = property_table,
+        };
+        int result = scan_run(&options);
+        diagnostics_print_summary();
+        free(filters);
+        return trace_stop() ? result : -1;
+    }
+    free(filters);
+
+    run_options_t options = {
+        .filename = filename,
+        .output_path = output_path,
+        .manifest_path = manifest_path,
+        .socket_path = socket_path,
+        .depfile_path = depfile_path,
+        .worker_count = worker_count,
+        .write_ir = write_ir,
+        .read_ir = read_ir,
+        .write_depfile = write_depfile,
+        .write_inline = write_inline,
+        .property_table = property_table,
+        // A traced run always generates in-process, since that's the work being traced.
+        // The server only renders with the default options and doesn't deal with IR, it keeps rendered sources in memory instead.
+        // It has its own alias table and log level, so runs that change either generate in-process too
+        .use_server = trace_path == NULL && !write_ir && !read_ir && !write_inline && !property_table && !has_aliases && !has_log_level,
+    };
+    int result = run(&options);
+    diagnostics_print_summary();
+    return trace_stop() ? result : -1;
+}
+
+// Private functions
+static int run(const run_options_t* options) {
+    if (options->manifest_path != NULL) {
+        return run_batch(options);
     }
 
     // Ensure input and output paths were found, return error if not
-    if (output_path == NULL) {
+    if (options->output_path == NULL) {
         return -1;
     }
-    if (filename == NULL) {
+    // The header isn't needed when emitting from IR
+    if (options->filename == NULL && !options->read_ir) {
         return -1;
     }
 
-    // Open file
-    FILE* input_file = fopen(filename, "r");
-    if (!input_file) {
-        return -1;
+    // Prefer a running server, fall back to generating in-process
+    b8 success = false;
+    if (options->use_server && options->socket_path != NULL && options->socket_path[0] != 0 &&
+            server_request(options->socket_path, options->filename, options->output_path, &success)) {
+        // The depfile only depends on the paths, so the client writes it
+        if (success && options->write_depfile) {
+            success = write_request_depfile(options->depfile_path, options->filename, options->output_path);
+        }
+        return success ? 0 : -1;
     }
 
-    // Get input file length
-    fseek(input_file, 0, SEEK_END);
-    long file_length = ftell(input_file);
-    fseek(input_file, 0, SEEK_SET);
+    generator_t generator;
+    generator_init(&generator);
+    apply_options(&generator, options);
+    generator.depfile_path = options->depfile_path;
+    success = generator_process_file(&generator, options->filename, options->output_path);
+    generator_shutdown(&generator);
 
-    // Allocate text buffers
-    char* text = (char*)malloc(file_length);
-    char* line_buffer = (char*)malloc(file_length); // Not required to be this long but is easy and relatively cheap
+    return success ? 0 : -1;
+}
 
-    // Read all text from file
-    fread(text, file_length, 1, input_file);
-    fclose(input_file);
-    memset(line_buffer, 0, file_length);
+// Processes every input/output pair listed in a manifest across worker_count threads.
+// Each non-empty line holds an input and an output path separated by whitespace.
+// Paths containing spaces can be wrapped in double quotes and lines starting with '#' are ignored.
+static int run_batch(const run_options_t* options) {
+    const char* manifest_path = options->manifest_path;
+    FILE* manifest_file = fopen(manifest_path, "r");
+    if (!manifest_file) {
+        log_error("Failed to open manifest '%s'.", manifest_path);
+        return -1;
+    }
 
-    // Open type header file
-    FILE* out_file = fopen(output_path, "w");
+    // Read the whole manifest
+    fseek(manifest_file, 0, SEEK_END);
+    long manifest_length = ftell(manifest_file);
+    fseek(manifest_file, 0, SEEK_SET);
 
-    // Read each line
-    char class_heirarchy[16][256] = {}; // Need to save a heirarchy for subclasses to work
-    int class_indents[16] = {};
-    int class_index = -1;
-    int indent = 0;
+    char* manifest = (char*)malloc(manifest_length + 1);
+    if (manifest_length > 0 && fread(manifest, manifest_length, 1, manifest_file) != 1) {
+        log_error("Failed to read manifest '%s'.", manifest_path);
+        fclose(manifest_file);
+        free(manifest);
+        return -1;
+    }
+    fclose(manifest_file);
+    manifest[manifest_length] = 0;
 
+    // Collect all entries. Paths point into the manifest buffer
+    batch_t batch = {};
+    int failed_count = 0;
+    char* cursor = manifest;
+    for (int line_number = 1; *cursor; line_number++) {
+        // Split off the current line
+        char* line = cursor;
+        char* line_end = strchr(cursor, '\n');
+        if (line_end) {
+            *line_end = 0;
+            cursor = line_end + 1;
+        } else {
+            cursor += strlen(cursor);
+        }
 
-    class_t class = {};
-    for (int i = 0, offset = 0; i < file_length; i++) {
-        const char c = text[i];
-        if (c == '\n') {
+        char* input_path = read_manifest_path(&line);
+        if (input_path == NULL || input_path[0] == '#') {
             continue;
         }
 
-        // Skip whitespace
-        if (offset == 0 && (c == ' ' || c == '\t')) {
+        char* output_path = read_manifest_path(&line);
+        if (output_path == NULL) {
+            log_error("%s:%d: Missing output path for '%s'.", manifest_path, line_number, input_path);
+            failed_count++;
             continue;
         }
 
-        // Modify indent
-        if (c == '{') {
-            indent++;
-        } else if (c == '}') {
-            indent--;
-            if (indent <= class_indents[class_index]) {
-                if (class_index >= 0) {
-                    class_write_exports(&class, filename, out_file);
-                    strcpy(class.name, class_heirarchy[class_index - 1]);
-                }
-                class_index--;
-            }
+        if (batch.entry_count >= batch.entry_capacity) {
+            batch.entry_capacity = batch.entry_capacity ? batch.entry_capacity * 2 : 64;
+            batch.entries = realloc(batch.entries, sizeof(batch_entry_t) * batch.entry_capacity);
         }
 
-        // Next keyword should be a class
-        if (strncmp(text + i, "class ", 6) == 0) {
-            int class_name_length = 0;
-            for (int j = 0; j < file_length - i; j++) {
-                char class_char = text[i + sizeof("class") + j];
+        // Missing files sort last and are reported by the generator
+        struct stat input_stat;
+        batch.entries[batch.entry_count++] = (batch_entry_t) {
+            .input_path = input_path,
+            .output_path = output_path,
+            .size = stat(input_path, &input_stat) == 0 ? input_stat.st_size : 0,
+        };
+    }
 
-                // Check if current char is not a valid character for a classname
-                if (!char_valid_in_name(class_char)) {
-                    class_name_length = j;
-                    break;
-                }
-            }
+    // Largest files first so a huge header never starts last and stalls the run
+    qsort(batch.entries, batch.entry_count, sizeof(batch_entry_t), compare_entry_size);
 
-            class_index++;
-            class_indents[class_index] = indent;
-            class_heirarchy[class_index][class_name_length] = 0;
-            memcpy(class_heirarchy[class_index], text + i + sizeof("class"), class_name_length);
-            memcpy(class.name, text + i + sizeof("class"), class_name_length);
-            printf("Found class '%s'\n", class_heirarchy[class_index]);
-            class.name[class_name_length] = 0;
+    int worker_count = options->worker_count;
+    if (worker_count > batch.entry_count) {
+        worker_count = batch.entry_count;
+    }
+    if (worker_count < 1) {
+        worker_count = 1;
+    }
+    batch.generators = malloc(sizeof(generator_t) * worker_count);
+    for (int i = 0; i < worker_count; i++) {
+        generator_init(&batch.generators[i]);
+        apply_options(&batch.generators[i], options);
+    }
 
-            i += sizeof("class") + class_name_length;
-            continue;
-        }
+    failed_count += job_pool_run(worker_count, batch.entry_count, run_batch_entry, &batch);
 
-        if (strncmp(text + i, "GD_EXPORT", 9) == 0) {
-            offset = 0;
-        }
+    for (int i = 0; i < worker_count; i++) {
+        generator_shutdown(&batch.generators[i]);
+    }
+    free(batch.generators);
+    free(batch.entries);
+    free(manifest);
 
-        // Check for line end and parse if in class declaration
-        b8 is_line_end = false;
-        for (int j = 0; j < line_end_count; j++) {
-            int end_length = strlen(line_ends[j]);
-            if (file_length - i < end_length) {
-                continue;
-            }
+    if (failed_count > 0) {
+        log_error("Failed to generate %d of %d files.", failed_count, batch.entry_count);
+        return -1;
+    }
 
-            if (strncmp(text + i, line_ends[j], end_length) == 0) {
-                i += end_length;
-                is_line_end = true;
-                line_buffer[offset++] = 0;
-                offset = 0;
+    return 0;
+}
 
-                if (class_index >= 0) {
-                    class_parse_line(&class, line_buffer);
-                }
-                break;
-            }
-        }
-        if (is_line_end) {
-            continue;
-        }
+// Depfile paths are per output, so they're only applied in file mode
+static void apply_options(generator_t* generator, const run_options_t* options) {
+    generator->write_ir = options->write_ir;
+    generator->read_ir = options->read_ir;
+    generator->write_depfile = options->write_depfile;
+    generator->write_inline = options->write_inline;
+    generator->property_table = options->property_table;
+}
+
+static b8 run_batch_entry(void* user_data, int worker_index, int job_index) {
+    batch_t* batch = user_data;
+    batch_entry_t* entry = &batch->entries[job_index];
+    return generator_process_file(&batch->generators[worker_index], entry->input_path, entry->output_path);
+}
+
+static int compare_entry_size(const void* a, const void* b) {
+    const batch_entry_t* entry_a = a;
+    const batch_entry_t* entry_b = b;
+    if (entry_a->size != entry_b->size) {
+        return entry_a->size > entry_b->size ? -1 : 1;
+    }
+
+    // Keep the order stable between runs
+    return strcmp(entry_a->input_path, entry_b->input_path);
+}
+
+// Reads the next whitespace separated (or quoted) path and advances the cursor past it.
+// Returns NULL if the line has no more paths.
+static char* read_manifest_path(char** cursor) {
+    char* c = *cursor;
+    while (*c == ' ' || *c == '\t' || *c == '\r') {
+        c++;
+    }
+    if (*c == 0) {
+        return NULL;
+    }
+
+    char terminator = ' ';
+    if (*c == '"') {
+        terminator = '"';
+        c++;
+    }
+
+    char* path = c;
+    while (*c && *c != terminator && (terminator == '"' || (*c != '\t' && *c != '\r'))) {
+        c++;
+    }
+
+    if (*c) {
+        *c = 0;
+        c++;
+    }
+    *cursor = c;
+    return path;
+}
 
-        // Build line
-        line_buffer[offset++] = c;
+static b8 write_request_depfile(const char* depfile_path, const char* input_path, const char* output_path) {
+    if (depfile_path) {
+        return depfile_write(depfile_path, &output_path, 1, &input_path, 1);
     }
 
-    fclose(out_file);
+    size_t length = strlen(output_path) + sizeof(DEPFILE_EXTENSION);
+    char* default_path = malloc(length);
+    snprintf(default_path, length, "%s%s", output_path, DEPFILE_EXTENSION);
+    b8 success = depfile_write(default_path, &output_path, 1, &input_path, 1);
+    free(default_path);
+    return success;
 }
@@ -0,0 +1,58 @@
+#include "code_gen/output_buffer.h"
+#include "code_gen/logging.h"
+#include "code_gen/trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Private data
+#define MIN_OUTPUT_CAPACITY 4096
+
+// Private functions
+static void reserve(output_buffer_t* buffer, size_t size);
+
+// Function Impls
+void output_buffer_init(output_buffer_t* buffer) {
+    memset(buffer, 0, sizeof(output_buffer_t));
+}
+
+void output_buffer_free(output_buffer_t* buffer) {
+    free(buffer->data);
+    memset(buffer, 0, sizeof(output_buffer_t));
+}
+
+void output_buffer_reset(output_buffer_t* buffer) {
+    buffer->size = 0;
+}
+
+void output_append(output_buffer_t* buffer, const char* data, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    if (buffer->size + size > buffer->capacity) {
+        reserve(buffer, buffer->size + size);
+    }
+
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+}
+
+void output_append_string(output_buffer_t* buffer, const char* string) {
+    output_append(buffer, string, strlen(string));
+}
+
+// Private functions
+static void reserve(output_buffer_t* buffer, size_t size) {
+    size_t capacity = buffer->capacity ? buffer->capacity : MIN_OUTPUT_CAPACITY;
+    while (capacity < size) {
+        capacity *= 2;
+    }
+
+    char* data = realloc(buffer->data, capacity);
+    if (!data) {
+        log_fatal("Failed to grow output buffer to %zu bytes.", capacity);
+    }
+    trace_count(TRACE_COUNTER_ALLOCATIONS, 1);
+    buffer->data = data;
+    buffer->capacity = capacity;
+}
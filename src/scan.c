@@ -0,0 +1,518 @@
+#include "code_gen/scan.h"
+#include "code_gen/depfile.h"
+#include "code_gen/file_utils.h"
+#include "code_gen/generator.h"
+#include "code_gen/ir.h"
+#include "code_gen/job_pool.h"
+#include "code_gen/logging.h"
+#include "code_gen/output_buffer.h"
+#include "code_gen/trace.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Private data
+static const char* default_filters[] = { "*.h", "*.hpp", };
+static const int default_filter_count = sizeof(default_filters) / sizeof(const char*);
+
+// Private structs
+typedef struct scan_entry {
+    char* input_path;
+    char* output_path;
+    long size;
+    b8 generated;
+    char* output; // Kept until the unity sources are written
+    size_t output_size;
+} scan_entry_t;
+
+typedef struct scan {
+    const scan_options_t* options;
+    scan_entry_t* entries;
+    int entry_count;
+    int entry_capacity;
+    generator_t* generators; // One per worker
+    b8 unity;
+
+    // Sources that were generated, listed by --list
+    char** source_paths;
+    int source_path_count;
+
+    // Directories already walked. Symlinks are followed, so a link back up the tree would otherwise never end
+    dev_t* visited_devices;
+    ino_t* visited_inodes;
+    int visited_count;
+    int visited_capacity;
+} scan_t;
+
+// Private functions
+static b8 walk_directory(scan_t* scan, const char* directory, const char* relative_directory);
+static b8 mark_visited(scan_t* scan, const struct stat* directory_stat);
+static b8 matches_filters(const scan_options_t* options, const char* name);
+static char* make_output_path(const char* output_directory, const char* relative_path);
+static b8 check_output_collisions(scan_t* scan);
+static b8 make_parent_directories(char* path);
+static b8 run_scan_entry(void* user_data, int worker_index, int job_index);
+static b8 generate_entry(scan_t* scan, scan_entry_t* entry, generator_t* generator);
+static void remove_outputs(const scan_entry_t* entry);
+static int compare_entry_size(const void* a, const void* b);
+static int compare_entry_path(const void* a, const void* b);
+static b8 write_unity_sources(scan_t* scan);
+static b8 write_unity_source(scan_t* scan, output_buffer_t* buffer, int unity_index, const char** inputs, int input_count);
+static void add_source_path(scan_t* scan, char* path);
+static b8 write_list(scan_t* scan);
+
+// Function Impls
+int scan_run(const scan_options_t* options) {
+    scan_t scan = {
+        .options = options,
+        .unity = options->unity_count > 0 || options->unity_bytes > 0,
+    };
+
+    // Directory walking is cheap compared to reading and parsing, so only the per-file work is parallel
+    b8 success = walk_directory(&scan, options->root_path, "");
+
+    // Two workers writing one output would race, and a header without exports would delete its sibling's output
+    if (!check_output_collisions(&scan)) {
+        for (int i = 0; i < scan.entry_count; i++) {
+            free(scan.entries[i].input_path);
+            free(scan.entries[i].output_path);
+        }
+        free(scan.entries);
+        free(scan.visited_devices);
+        free(scan.visited_inodes);
+        return -1;
+    }
+
+    // Largest files first so a huge header never starts last and stalls the run
+    qsort(scan.entries, scan.entry_count, sizeof(scan_entry_t), compare_entry_size);
+
+    int worker_count = options->worker_count;
+    if (worker_count > scan.entry_count) {
+        worker_count = scan.entry_count;
+    }
+    if (worker_count < 1) {
+        worker_count = 1;
+    }
+    scan.generators = malloc(sizeof(generator_t) * worker_count);
+    for (int i = 0; i < worker_count; i++) {
+        generator_init(&scan.generators[i]);
+        scan.generators[i].write_inline = options->write_inline;
+        scan.generators[i].property_table = options->property_table;
+    }
+
+    int failed_count = job_pool_run(worker_count, scan.entry_count, run_scan_entry, &scan);
+
+    for (int i = 0; i < worker_count; i++) {
+        generator_shutdown(&scan.generators[i]);
+    }
+    free(scan.generators);
+
+    int generated_count = 0;
+    for (int i = 0; i < scan.entry_count; i++) {
+        generated_count += scan.entries[i].generated;
+    }
+    log_info("Generated %d of %d headers.", generated_count, scan.entry_count);
+
+    // Sources are listed in path order so the list only changes when the set of sources does
+    qsort(scan.entries, scan.entry_count, sizeof(scan_entry_t), compare_entry_path);
+    if (scan.unity) {
+        success = write_unity_sources(&scan) && success;
+    } else {
+        for (int i = 0; i < scan.entry_count; i++) {
+            if (scan.entries[i].generated) {
+                add_source_path(&scan, strdup(scan.entries[i].output_path));
+            }
+        }
+    }
+
+    if (options->list_path && !write_list(&scan)) {
+        success = false;
+    }
+
+    for (int i = 0; i < scan.entry_count; i++) {
+        free(scan.entries[i].input_path);
+        free(scan.entries[i].output_path);
+        free(scan.entries[i].output);
+    }
+    free(scan.entries);
+    for (int i = 0; i < scan.source_path_count; i++) {
+        free(scan.source_paths[i]);
+    }
+    free(scan.source_paths);
+    free(scan.visited_devices);
+    free(scan.visited_inodes);
+
+    if (failed_count > 0) {
+        log_error("Failed to generate %d of %d headers.", failed_count, scan.entry_count);
+        return -1;
+    }
+
+    return success ? 0 : -1;
+}
+
+// Private functions
+static b8 walk_directory(scan_t* scan, const char* directory, const char* relative_directory) {
+    DIR* dir = opendir(directory);
+    if (!dir) {
+        log_error("Failed to open directory '%s': %s", directory, strerror(errno));
+        return false;
+    }
+
+    // Reached again through a symlink, everything below it is already in the scan
+    struct stat directory_stat;
+    if (fstat(dirfd(dir), &directory_stat) == 0 && !mark_visited(scan, &directory_stat)) {
+        log_debug("Skipping '%s', it was already scanned.", directory);
+        closedir(dir);
+        return true;
+    }
+
+    b8 success = true;
+    struct dirent* dir_entry;
+    while ((dir_entry = readdir(dir)) != NULL) {
+        const char* name = dir_entry->d_name;
+        if (name[0] == '.') {
+            continue;
+        }
+
+        size_t path_length = strlen(directory) + strlen(name) + 2;
+        size_t relative_length = strlen(relative_directory) + strlen(name) + 2;
+        char* path = malloc(path_length);
+        char* relative_path = malloc(relative_length);
+        snprintf(path, path_length, "%s/%s", directory, name);
+        snprintf(relative_path, relative_length, "%s%s%s", relative_directory, relative_directory[0] ? "/" : "", name);
+
+        struct stat path_stat;
+        if (stat(path, &path_stat) != 0) {
+            log_warn("Failed to stat '%s': %s", path, strerror(errno));
+        } else if (S_ISDIR(path_stat.st_mode)) {
+            success = walk_directory(scan, path, relative_path) && success;
+        } else if (S_ISREG(path_stat.st_mode) && matches_filters(scan->options, name)) {
+            if (scan->entry_count >= scan->entry_capacity) {
+                scan->entry_capacity = scan->entry_capacity ? scan->entry_capacity * 2 : 256;
+                scan->entries = realloc(scan->entries, sizeof(scan_entry_t) * scan->entry_capacity);
+            }
+
+            // Ownership of path moves to the entry
+            scan->entries[scan->entry_count++] = (scan_entry_t) {
+                .input_path = path,
+                .output_path = make_output_path(scan->options->output_path, relative_path),
+                .size = path_stat.st_size,
+            };
+            path = NULL;
+        }
+
+        free(path);
+        free(relative_path);
+    }
+
+    closedir(dir);
+    return success;
+}
+
+// Returns false if the directory was visited before
+static b8 mark_visited(scan_t* scan, const struct stat* directory_stat) {
+    for (int i = 0; i < scan->visited_count; i++) {
+        if (scan->visited_inodes[i] == directory_stat->st_ino && scan->visited_devices[i] == directory_stat->st_dev) {
+            return false;
+        }
+    }
+
+    if (scan->visited_count >= scan->visited_capacity) {
+        scan->visited_capacity = scan->visited_capacity ? scan->visited_capacity * 2 : 64;
+        scan->visited_devices = realloc(scan->visited_devices, sizeof(dev_t) * scan->visited_capacity);
+        scan->visited_inodes = realloc(scan->visited_inodes, sizeof(ino_t) * scan->visited_capacity);
+    }
+    scan->visited_devices[scan->visited_count] = directory_stat->st_dev;
+    scan->visited_inodes[scan->visited_count] = directory_stat->st_ino;
+    scan->visited_count++;
+    return true;
+}
+
+static b8 matches_filters(const scan_options_t* options, const char* name) {
+    const char** filters = options->filter_count > 0 ? options->filters : default_filters;
+    int filter_count = options->filter_count > 0 ? options->filter_count : default_filter_count;
+    for (int i = 0; i < filter_count; i++) {
+        if (fnmatch(filters[i], name, 0) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Swaps the header's extension for .cpp under the output directory
+static char* make_output_path(const char* output_directory, const char* relative_path) {
+    const char* extension = strrchr(relative_path, '.');
+    const char* last_separator = strrchr(relative_path, '/');
+    int stem_length = extension && (!last_separator || extension > last_separator) ? extension - relative_path : (int)strlen(relative_path);
+
+    size_t length = strlen(output_directory) + stem_length + sizeof("/.cpp");
+    char* output_path = malloc(length);
+    snprintf(output_path, length, "%s/%.*s.cpp", output_directory, stem_length, relative_path);
+    return output_path;
+}
+
+// Headers that differ only by extension, like foo.h and foo.hpp, map to the same output
+static b8 check_output_collisions(scan_t* scan) {
+    qsort(scan->entries, scan->entry_count, sizeof(scan_entry_t), compare_entry_path);
+
+    b8 success = true;
+    for (int i = 1; i < scan->entry_count; i++) {
+        if (strcmp(scan->entries[i - 1].output_path, scan->entries[i].output_path) == 0) {
+            log_error("'%s' and '%s' both generate '%s'.", scan->entries[i - 1].input_path, scan->entries[i].input_path, scan->entries[i].output_path);
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+static b8 make_parent_directories(char* path) {
+    for (char* c = path + 1; *c; c++) {
+        if (*c != '/') {
+            continue;
+        }
+
+        // Other workers may create the same directory at the same time
+        *c = 0;
+        b8 created = mkdir(path, 0777) == 0 || errno == EEXIST;
+        *c = '/';
+        if (!created) {
+            log_error("Failed to create directory for '%s': %s", path, strerror(errno));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static b8 run_scan_entry(void* user_data, int worker_index, int job_index) {
+    scan_t* scan = user_data;
+    scan_entry_t* entry = &scan->entries[job_index];
+
+    trace_span_t span = trace_begin(TRACE_SPAN_FILE);
+    b8 success = generate_entry(scan, entry, &scan->generators[worker_index]);
+    trace_count(TRACE_COUNTER_FILES, 1);
+    trace_end(span, entry->input_path);
+    trace_sample_counters();
+    return success;
+}
+
+static b8 generate_entry(scan_t* scan, scan_entry_t* entry, generator_t* generator) {
+    if (!generator_load_file(generator, entry->input_path)) {
+        return false;
+    }
+
+    // Most headers in a project have nothing to generate, skip them before parsing.
+    // The header may have had exports on an earlier run, so whatever was generated for it then is removed
+    if (!generator_may_have_exports(generator)) {
+        remove_outputs(entry);
+        return true;
+    }
+
+    const char* output = NULL;
+    size_t output_size = 0;
+    if (!generator_render(generator, entry->input_path, &output, &output_size)) {
+        return false;
+    }
+
+    if (scan->options->write_ir) {
+        size_t length = strlen(entry->output_path) + sizeof(IR_EXTENSION);
+        char* ir_path = malloc(length);
+        snprintf(ir_path, length, "%s%s", entry->output_path, IR_EXTENSION);
+        b8 written = make_parent_directories(ir_path) && generator_write_ir(generator, entry->input_path, ir_path);
+        free(ir_path);
+        if (!written) {
+            return false;
+        }
+    }
+
+    // Companions are included by their header, so they're written per header even in unity mode
+    if (scan->options->write_inline &&
+            !(make_parent_directories(entry->output_path) && generator_write_inline(generator, entry->input_path, entry->output_path))) {
+        return false;
+    }
+
+    // Unity sources are written once every header has been rendered
+    if (scan->unity) {
+        entry->output = malloc(output_size ? output_size : 1);
+        memcpy(entry->output, output, output_size);
+        entry->output_size = output_size;
+        entry->generated = true;
+        return true;
+    }
+
+    b8 success = make_parent_directories(entry->output_path) &&
+        write_file_if_changed(entry->output_path, output, output_size, NULL);
+
+    if (success && scan->options->write_depfile) {
+        char* inline_path = scan->options->write_inline ? generator_inline_path(entry->output_path) : NULL;
+        char* ir_path = NULL;
+        const char* targets[3] = { entry->output_path };
+        int target_count = 1;
+        if (inline_path) {
+            targets[target_count++] = inline_path;
+        }
+        if (scan->options->write_ir) {
+            size_t length = strlen(entry->output_path) + sizeof(IR_EXTENSION);
+            ir_path = malloc(length);
+            snprintf(ir_path, length, "%s%s", entry->output_path, IR_EXTENSION);
+            targets[target_count++] = ir_path;
+        }
+
+        size_t length = strlen(entry->output_path) + sizeof(DEPFILE_EXTENSION);
+        char* depfile_path = malloc(length);
+        snprintf(depfile_path, length, "%s%s", entry->output_path, DEPFILE_EXTENSION);
+        success = depfile_write(depfile_path, targets, target_count, (const char**)&entry->input_path, 1);
+        free(depfile_path);
+        free(inline_path);
+        free(ir_path);
+    }
+
+    entry->generated = success;
+    return success;
+}
+
+// Removes every file a previous run may have generated for the entry. Missing files are expected
+static void remove_outputs(const scan_entry_t* entry) {
+    const char* extensions[] = { "", DEPFILE_EXTENSION, IR_EXTENSION };
+    for (int i = 0; i < (int)(sizeof(extensions) / sizeof(const char*)); i++) {
+        size_t length = strlen(entry->output_path) + strlen(extensions[i]) + 1;
+        char* path = malloc(length);
+        snprintf(path, length, "%s%s", entry->output_path, extensions[i]);
+        unlink(path);
+        free(path);
+    }
+
+    // The header still includes its companion, so it goes whether or not this run writes companions
+    char* inline_path = generator_inline_path(entry->output_path);
+    unlink(inline_path);
+    free(inline_path);
+}
+
+static int compare_entry_size(const void* a, const void* b) {
+    const scan_entry_t* entry_a = a;
+    const scan_entry_t* entry_b = b;
+    if (entry_a->size != entry_b->size) {
+        return entry_a->size > entry_b->size ? -1 : 1;
+    }
+
+    // Keep the order stable between runs
+    return strcmp(entry_a->input_path, entry_b->input_path);
+}
+
+static int compare_entry_path(const void* a, const void* b) {
+    const scan_entry_t* entry_a = a;
+    const scan_entry_t* entry_b = b;
+    return strcmp(entry_a->output_path, entry_b->output_path);
+}
+
+// Groups the rendered headers (already sorted by path) into unity sources
+static b8 write_unity_sources(scan_t* scan) {
+    const scan_options_t* options = scan->options;
+    output_buffer_t buffer;
+    output_buffer_init(&buffer);
+    const char** group_inputs = malloc(sizeof(const char*) * (scan->entry_count + 1));
+
+    b8 success = true;
+    int unity_count = 0;
+    int group_header_count = 0;
+    for (int i = 0; i < scan->entry_count; i++) {
+        scan_entry_t* entry = &scan->entries[i];
+        if (!entry->generated) {
+            continue;
+        }
+
+        // Close the current group if this header doesn't fit. A group always takes at least one header
+        b8 full = (options->unity_count > 0 && group_header_count >= options->unity_count) ||
+            (options->unity_bytes > 0 && group_header_count > 0 && buffer.size + entry->output_size > (size_t)options->unity_bytes);
+        if (full) {
+            success = write_unity_source(scan, &buffer, unity_count++, group_inputs, group_header_count) && success;
+            output_buffer_reset(&buffer);
+            group_header_count = 0;
+        }
+
+        // Classes without data end without a newline, so headers need to be separated
+        output_append_literal(&buffer, "// ");
+        output_append_string(&buffer, entry->input_path);
+        output_append_literal(&buffer, "\n");
+        output_append(&buffer, entry->output, entry->output_size);
+        output_append_literal(&buffer, "\n");
+        group_inputs[group_header_count++] = entry->input_path;
+    }
+    if (group_header_count > 0) {
+        success = write_unity_source(scan, &buffer, unity_count++, group_inputs, group_header_count) && success;
+    }
+    output_buffer_free(&buffer);
+    free(group_inputs);
+
+    // Remove sources left over from a run that had more groups
+    for (int i = unity_count;; i++) {
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/unity_%d.cpp%s", options->output_path, i, DEPFILE_EXTENSION);
+        unlink(path);
+        snprintf(path, sizeof(path), "%s/unity_%d.cpp", options->output_path, i);
+        if (unlink(path) != 0) {
+            break;
+        }
+    }
+
+    return success;
+}
+
+static b8 write_unity_source(scan_t* scan, output_buffer_t* buffer, int unity_index, const char** inputs, int input_count) {
+    size_t length = strlen(scan->options->output_path) + sizeof("/unity_.cpp") + sizeof(DEPFILE_EXTENSION) + 12;
+    char* path = malloc(length);
+    snprintf(path, length, "%s/unity_%d.cpp", scan->options->output_path, unity_index);
+
+    if (!make_parent_directories(path) || !write_file_if_changed(path, buffer->data, buffer->size, NULL)) {
+        free(path);
+        return false;
+    }
+
+    if (scan->options->write_depfile) {
+        char* depfile_path = malloc(length);
+        snprintf(depfile_path, length, "%s%s", path, DEPFILE_EXTENSION);
+        b8 written = depfile_write(depfile_path, (const char**)&path, 1, inputs, input_count);
+        free(depfile_path);
+        if (!written) {
+            free(path);
+            return false;
+        }
+    }
+
+    add_source_path(scan, path);
+    return true;
+}
+
+// Ownership of path moves to the scan
+static void add_source_path(scan_t* scan, char* path) {
+    scan->source_paths = realloc(scan->source_paths, sizeof(char*) * (scan->source_path_count + 1));
+    scan->source_paths[scan->source_path_count++] = path;
+}
+
+// Lists generated sources so the build knows what to compile. Only rewritten when the set of sources changes
+static b8 write_list(scan_t* scan) {
+    char* list = NULL;
+    size_t list_size = 0;
+    FILE* list_file = open_memstream(&list, &list_size);
+    if (!list_file) {
+        log_error("Failed to create list buffer.");
+        return false;
+    }
+
+    for (int i = 0; i < scan->source_path_count; i++) {
+        fprintf(list_file, "%s\n", scan->source_paths[i]);
+    }
+    fclose(list_file);
+
+    b8 success = write_file_if_changed(scan->options->list_path, list, list_size, NULL);
+    free(list);
+    return success;
+}
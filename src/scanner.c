@@ -0,0 +1,263 @@
+#include "code_gen/scanner.h"
+#include "code_gen/defines.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCANNER_X86 1
+#endif
+
+// Private functions
+static long find_any_scalar(const char* text, long start, long length, char a, char b, char c);
+static long skip_space_scalar(const char* text, long start, long length);
+static long find_candidate_scalar(const char* text, long start, long length);
+#ifdef SCANNER_X86
+static b8 has_avx2(void);
+static long find_any_sse2(const char* text, long start, long length, char a, char b, char c);
+static long find_any_avx2(const char* text, long start, long length, char a, char b, char c);
+static long skip_space_sse2(const char* text, long start, long length);
+static long find_candidate_sse2(const char* text, long start, long length);
+static long find_candidate_avx2(const char* text, long start, long length);
+#endif
+
+// Function Impls
+long scanner_find_any(const char* text, long start, long length, char a, char b, char c) {
+#ifdef SCANNER_X86
+    if (has_avx2()) {
+        return find_any_avx2(text, start, length, a, b, c);
+    }
+    return find_any_sse2(text, start, length, a, b, c);
+#else
+    return find_any_scalar(text, start, length, a, b, c);
+#endif
+}
+
+long scanner_skip_space(const char* text, long start, long length) {
+    // Whitespace runs are mostly indentation, shorter than a 32 byte block
+#ifdef SCANNER_X86
+    return skip_space_sse2(text, start, length);
+#else
+    return skip_space_scalar(text, start, length);
+#endif
+}
+
+long scanner_find_candidate(const char* text, long start, long length) {
+#ifdef SCANNER_X86
+    if (has_avx2()) {
+        return find_candidate_avx2(text, start, length);
+    }
+    return find_candidate_sse2(text, start, length);
+#else
+    return find_candidate_scalar(text, start, length);
+#endif
+}
+
+// Private functions
+static inline b8 is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline b8 is_candidate(const char* text, long i, long length) {
+    const char c = text[i];
+    if (c == '{' || c == '}' || c == ';' || c == '/' || c == '"' || c == '\'' || c == '#') {
+        return true;
+    }
+
+    // Pairs keep common letters from stopping the scan at every 'c' or 'e'
+    if (i + 1 < length) {
+        const char next = text[i + 1];
+        return (c == 'c' && next == 'l') || (c == 'e' && next == 'n') || (c == 'G' && next == 'D') || (c == '_' && next == 'b');
+    }
+    return false;
+}
+
+static long find_any_scalar(const char* text, long start, long length, char a, char b, char c) {
+    for (long i = start; i < length; i++) {
+        if (text[i] == a || text[i] == b || text[i] == c) {
+            return i;
+        }
+    }
+    return length;
+}
+
+static long skip_space_scalar(const char* text, long start, long length) {
+    for (long i = start; i < length; i++) {
+        if (!is_space(text[i])) {
+            return i;
+        }
+    }
+    return length;
+}
+
+static long find_candidate_scalar(const char* text, long start, long length) {
+    for (long i = start; i < length; i++) {
+        if (is_candidate(text, i, length)) {
+            return i;
+        }
+    }
+    return length;
+}
+
+#ifdef SCANNER_X86
+// Resolved once, every thread computes the same value so a relaxed race is harmless
+static b8 has_avx2(void) {
+    static int cpu_has_avx2 = -1;
+    int avx2 = __atomic_load_n(&cpu_has_avx2, __ATOMIC_RELAXED);
+    if (avx2 < 0) {
+        __builtin_cpu_init();
+        avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+        __atomic_store_n(&cpu_has_avx2, avx2, __ATOMIC_RELAXED);
+    }
+    return avx2;
+}
+
+static long find_any_sse2(const char* text, long start, long length, char a, char b, char c) {
+    const __m128i byte_a = _mm_set1_epi8(a);
+    const __m128i byte_b = _mm_set1_epi8(b);
+    const __m128i byte_c = _mm_set1_epi8(c);
+
+    long i = start;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i*)(text + i));
+        const __m128i match = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, byte_a), _mm_cmpeq_epi8(block, byte_b)),
+                _mm_cmpeq_epi8(block, byte_c));
+
+        int mask = _mm_movemask_epi8(match);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    return find_any_scalar(text, i, length, a, b, c);
+}
+
+__attribute__((target("avx2")))
+static long find_any_avx2(const char* text, long start, long length, char a, char b, char c) {
+    const __m256i byte_a = _mm256_set1_epi8(a);
+    const __m256i byte_b = _mm256_set1_epi8(b);
+    const __m256i byte_c = _mm256_set1_epi8(c);
+
+    long i = start;
+    for (; i + 32 <= length; i += 32) {
+        const __m256i block = _mm256_loadu_si256((const __m256i*)(text + i));
+        const __m256i match = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, byte_a), _mm256_cmpeq_epi8(block, byte_b)),
+                _mm256_cmpeq_epi8(block, byte_c));
+
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(match);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    return find_any_sse2(text, i, length, a, b, c);
+}
+
+static long skip_space_sse2(const char* text, long start, long length) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i control_range = _mm_set1_epi8('\r' - '\t');
+
+    long i = start;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i*)(text + i));
+
+        // '\t' to '\r' are contiguous, bytes below '\t' wrap around and fall outside the range
+        const __m128i control = _mm_sub_epi8(block, tab);
+        const __m128i is_control = _mm_cmpeq_epi8(_mm_min_epu8(control, control_range), control);
+        const __m128i is_space = _mm_or_si128(_mm_cmpeq_epi8(block, space), is_control);
+
+        int mask = ~_mm_movemask_epi8(is_space) & 0xFFFF;
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    return skip_space_scalar(text, i, length);
+}
+
+static long find_candidate_sse2(const char* text, long start, long length) {
+    const __m128i open_brace = _mm_set1_epi8('{');
+    const __m128i close_brace = _mm_set1_epi8('}');
+    const __m128i semicolon = _mm_set1_epi8(';');
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i apostrophe = _mm_set1_epi8('\'');
+    const __m128i hash = _mm_set1_epi8('#');
+    const __m128i c = _mm_set1_epi8('c');
+    const __m128i l = _mm_set1_epi8('l');
+    const __m128i e = _mm_set1_epi8('e');
+    const __m128i n = _mm_set1_epi8('n');
+    const __m128i g = _mm_set1_epi8('G');
+    const __m128i d = _mm_set1_epi8('D');
+    const __m128i underscore = _mm_set1_epi8('_');
+    const __m128i b = _mm_set1_epi8('b');
+
+    // The second load reads one byte ahead for the pair checks
+    long i = start;
+    for (; i + 17 <= length; i += 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i*)(text + i));
+        const __m128i next = _mm_loadu_si128((const __m128i*)(text + i + 1));
+
+        __m128i match = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, open_brace), _mm_cmpeq_epi8(block, close_brace)),
+            _mm_or_si128(_mm_cmpeq_epi8(block, semicolon), _mm_cmpeq_epi8(block, slash)));
+        match = _mm_or_si128(match, _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, apostrophe)),
+            _mm_cmpeq_epi8(block, hash)));
+        match = _mm_or_si128(match, _mm_and_si128(_mm_cmpeq_epi8(block, c), _mm_cmpeq_epi8(next, l)));
+        match = _mm_or_si128(match, _mm_and_si128(_mm_cmpeq_epi8(block, e), _mm_cmpeq_epi8(next, n)));
+        match = _mm_or_si128(match, _mm_and_si128(_mm_cmpeq_epi8(block, g), _mm_cmpeq_epi8(next, d)));
+        match = _mm_or_si128(match, _mm_and_si128(_mm_cmpeq_epi8(block, underscore), _mm_cmpeq_epi8(next, b)));
+
+        int mask = _mm_movemask_epi8(match);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    return find_candidate_scalar(text, i, length);
+}
+
+__attribute__((target("avx2")))
+static long find_candidate_avx2(const char* text, long start, long length) {
+    const __m256i open_brace = _mm256_set1_epi8('{');
+    const __m256i close_brace = _mm256_set1_epi8('}');
+    const __m256i semicolon = _mm256_set1_epi8(';');
+    const __m256i slash = _mm256_set1_epi8('/');
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i apostrophe = _mm256_set1_epi8('\'');
+    const __m256i hash = _mm256_set1_epi8('#');
+    const __m256i c = _mm256_set1_epi8('c');
+    const __m256i l = _mm256_set1_epi8('l');
+    const __m256i e = _mm256_set1_epi8('e');
+    const __m256i n = _mm256_set1_epi8('n');
+    const __m256i g = _mm256_set1_epi8('G');
+    const __m256i d = _mm256_set1_epi8('D');
+    const __m256i underscore = _mm256_set1_epi8('_');
+    const __m256i b = _mm256_set1_epi8('b');
+
+    // The second load reads one byte ahead for the pair checks
+    long i = start;
+    for (; i + 33 <= length; i += 32) {
+        const __m256i block = _mm256_loadu_si256((const __m256i*)(text + i));
+        const __m256i next = _mm256_loadu_si256((const __m256i*)(text + i + 1));
+
+        __m256i match = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, open_brace), _mm256_cmpeq_epi8(block, close_brace)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, semicolon), _mm256_cmpeq_epi8(block, slash)));
+        match = _mm256_or_si256(match, _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, apostrophe)),
+            _mm256_cmpeq_epi8(block, hash)));
+        match = _mm256_or_si256(match, _mm256_and_si256(_mm256_cmpeq_epi8(block, c), _mm256_cmpeq_epi8(next, l)));
+        match = _mm256_or_si256(match, _mm256_and_si256(_mm256_cmpeq_epi8(block, e), _mm256_cmpeq_epi8(next, n)));
+        match = _mm256_or_si256(match, _mm256_and_si256(_mm256_cmpeq_epi8(block, g), _mm256_cmpeq_epi8(next, d)));
+        match = _mm256_or_si256(match, _mm256_and_si256(_mm256_cmpeq_epi8(block, underscore), _mm256_cmpeq_epi8(next, b)));
+
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(match);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    return find_candidate_sse2(text, i, length);
+}
+#endif
@@ -0,0 +1,357 @@
+#include "code_gen/server.h"
+#include "code_gen/diagnostics.h"
+#include "code_gen/file_utils.h"
+#include "code_gen/generator.h"
+#include "code_gen/logging.h"
+#include "code_gen/string_utils.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Private data
+#define CACHE_BUCKET_COUNT 4096
+#define MAX_REQUEST_SIZE (3 * 4096)
+// Clients are served one at a time, so one that stalls mid-request is dropped before it holds up the build
+#define CLIENT_TIMEOUT_SECONDS 5
+
+// Request layout: "<client cwd>\0<input path>\0<output path>\0"
+// Response layout: "<status><error count> <warning count>\n<diagnostics>", status is '0' on success or '1' on failure.
+// Diagnostics are rendered by the server and printed by the client, so a failed build step shows why it failed
+#define RESPONSE_SUCCESS '0'
+#define RESPONSE_FAILURE '1'
+#define MAX_RESPONSE_HEADER_SIZE 32
+
+// Private structs
+typedef struct cache_entry {
+    struct cache_entry* next;
+    char* input_path;
+    u64 text_hash;
+    char* output;
+    size_t output_size;
+    char* diagnostics; // Warnings of the render, replayed on every hit
+    size_t diagnostics_size;
+    int warning_count;
+} cache_entry_t;
+
+typedef struct render_cache {
+    cache_entry_t* buckets[CACHE_BUCKET_COUNT];
+    int hit_count;
+    int miss_count;
+} render_cache_t;
+
+static volatile sig_atomic_t server_stopping = 0;
+
+// Private functions
+static b8 make_address(const char* socket_path, struct sockaddr_un* out_address);
+static void handle_signal(int signal);
+static void handle_client(int client, generator_t* generator, render_cache_t* cache);
+static b8 generate_cached(generator_t* generator, render_cache_t* cache, const char* input_path, const char* output_path, log_capture_t* capture);
+static b8 write_all(int fd, const char* data, size_t size);
+static void cache_clear(render_cache_t* cache);
+
+// Function Impls
+int server_run(const char* socket_path) {
+    struct sockaddr_un address;
+    if (!make_address(socket_path, &address)) {
+        return -1;
+    }
+
+    // Refuse to replace a live server, but clean up a socket left behind by a crashed one
+    if (server_request(socket_path, NULL, NULL, NULL)) {
+        log_error("A server is already listening on '%s'.", socket_path);
+        return -1;
+    }
+    unlink(socket_path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        log_error("Failed to create socket: %s", strerror(errno));
+        return -1;
+    }
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 64) != 0) {
+        log_error("Failed to listen on '%s': %s", socket_path, strerror(errno));
+        close(listener);
+        return -1;
+    }
+
+    // Clients hanging up early must not kill the server
+    signal(SIGPIPE, SIG_IGN);
+    struct sigaction stop_action = {};
+    stop_action.sa_handler = handle_signal;
+    sigaction(SIGINT, &stop_action, NULL);
+    sigaction(SIGTERM, &stop_action, NULL);
+
+    log_info("Listening on '%s'.", socket_path);
+
+    generator_t generator;
+    generator_init(&generator);
+    render_cache_t* cache = calloc(1, sizeof(render_cache_t));
+
+    while (!server_stopping) {
+        int client = accept(listener, NULL, NULL);
+        if (client < 0) {
+            if (errno != EINTR) {
+                log_error("Failed to accept client: %s", strerror(errno));
+            }
+            continue;
+        }
+
+        handle_client(client, &generator, cache);
+        close(client);
+    }
+
+    log_info("Stopping server. Cache hits: %d, misses: %d.", cache->hit_count, cache->miss_count);
+
+    cache_clear(cache);
+    free(cache);
+    generator_shutdown(&generator);
+    close(listener);
+    unlink(socket_path);
+
+    return 0;
+}
+
+b8 server_request(const char* socket_path, const char* input_path, const char* output_path, b8* out_success) {
+    struct sockaddr_un address;
+    if (!make_address(socket_path, &address)) {
+        return false;
+    }
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) {
+        return false;
+    }
+    if (connect(server, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        close(server);
+        return false;
+    }
+
+    // A NULL request only probes whether the server is alive
+    if (input_path == NULL || output_path == NULL) {
+        close(server);
+        return true;
+    }
+
+    // Paths are sent as given so the emitted include matches an in-process run.
+    // The server resolves them relative to our working directory
+    char request[MAX_REQUEST_SIZE];
+    char cwd[4096];
+    if (!getcwd(cwd, sizeof(cwd))) {
+        close(server);
+        return false;
+    }
+
+    int request_size = snprintf(request, sizeof(request), "%s%c%s%c%s%c", cwd, 0, input_path, 0, output_path, 0);
+    if (request_size < 0 || request_size >= (int)sizeof(request)) {
+        close(server);
+        return false;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    b8 sent = write_all(server, request, request_size);
+    shutdown(server, SHUT_WR);
+
+    // Read until the server closes the connection
+    output_buffer_t response;
+    output_buffer_init(&response);
+    char chunk[4096];
+    ssize_t read_count = 0;
+    while (sent && (read_count = read(server, chunk, sizeof(chunk))) > 0) {
+        output_append(&response, chunk, read_count);
+    }
+    close(server);
+
+    // Treat a server that died mid-request like no server at all
+    const char* header_end = response.size > 0 ? memchr(response.data, '\n', response.size) : NULL;
+    int error_count = 0;
+    int warning_count = 0;
+    if (read_count < 0 || !header_end || sscanf(response.data + 1, "%d %d", &error_count, &warning_count) != 2) {
+        output_buffer_free(&response);
+        return false;
+    }
+
+    size_t diagnostics_start = header_end - response.data + 1;
+    diagnostics_forward(response.data + diagnostics_start, response.size - diagnostics_start, error_count, warning_count);
+    *out_success = response.data[0] == RESPONSE_SUCCESS;
+    output_buffer_free(&response);
+    return true;
+}
+
+// Private functions
+static b8 make_address(const char* socket_path, struct sockaddr_un* out_address) {
+    memset(out_address, 0, sizeof(struct sockaddr_un));
+    out_address->sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(out_address->sun_path)) {
+        log_error("Socket path '%s' is too long.", socket_path);
+        return false;
+    }
+
+    strcpy(out_address->sun_path, socket_path);
+    return true;
+}
+
+static void handle_signal(int signal) {
+    (void)signal;
+    server_stopping = 1;
+}
+
+static void handle_client(int client, generator_t* generator, render_cache_t* cache) {
+    struct timeval timeout = { .tv_sec = CLIENT_TIMEOUT_SECONDS };
+    if (setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0) {
+        log_warn("Failed to set client timeout: %s", strerror(errno));
+    }
+
+    // Read until the client shuts down its side
+    char request[MAX_REQUEST_SIZE];
+    int request_size = 0;
+    while (request_size < (int)sizeof(request)) {
+        ssize_t read_count = read(client, request + request_size, sizeof(request) - request_size);
+        if (read_count < 0 && errno == EINTR && !server_stopping) {
+            continue;
+        }
+        if (read_count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            log_warn("Dropping client that sent no request within %d seconds.", CLIENT_TIMEOUT_SECONDS);
+            return;
+        }
+        if (read_count <= 0) {
+            break;
+        }
+        request_size += read_count;
+    }
+
+    // Probes send nothing
+    if (request_size == 0) {
+        return;
+    }
+
+    // Split request into its three strings
+    const char* fields[3] = {};
+    int field_count = 0;
+    for (int i = 0, start = 0; i < request_size && field_count < 3; i++) {
+        if (request[i] == 0) {
+            fields[field_count++] = request + start;
+            start = i + 1;
+        }
+    }
+
+    // Everything reported while generating goes back to the client instead of the server's output
+    output_buffer_t diagnostics;
+    output_buffer_init(&diagnostics);
+    generator->diagnostics.capture = &diagnostics;
+    generator->diagnostics.captured_error_count = 0;
+    generator->diagnostics.captured_warning_count = 0;
+    log_capture_t capture = { .messages = &diagnostics };
+    log_set_capture(&capture);
+
+    char status = RESPONSE_FAILURE;
+    if (field_count != 3) {
+        log_error("Received malformed request.");
+    } else if (chdir(fields[0]) != 0) {
+        log_error("Failed to enter client directory '%s': %s", fields[0], strerror(errno));
+    } else if (generate_cached(generator, cache, fields[1], fields[2], &capture)) {
+        status = RESPONSE_SUCCESS;
+    }
+
+    log_set_capture(NULL);
+    generator->diagnostics.capture = NULL;
+
+    char header[MAX_RESPONSE_HEADER_SIZE];
+    int header_size = snprintf(header, sizeof(header), "%c%d %d\n", status,
+            generator->diagnostics.captured_error_count + capture.error_count,
+            generator->diagnostics.captured_warning_count + capture.warning_count);
+    if (!write_all(client, header, header_size) || !write_all(client, diagnostics.data, diagnostics.size)) {
+        log_warn("Client disconnected before receiving a response.");
+    }
+    output_buffer_free(&diagnostics);
+}
+
+static b8 generate_cached(generator_t* generator, render_cache_t* cache, const char* input_path, const char* output_path, log_capture_t* capture) {
+    if (!generator_load_file(generator, input_path)) {
+        return false;
+    }
+
+    // The input path is part of the output (through the emitted include), so it is part of the key
+    u64 text_hash = hash_bytes(generator->text, generator->text_length);
+    u64 path_hash = hash_bytes(input_path, strlen(input_path));
+    cache_entry_t** bucket = &cache->buckets[path_hash % CACHE_BUCKET_COUNT];
+
+    cache_entry_t* entry = *bucket;
+    while (entry && strcmp(entry->input_path, input_path) != 0) {
+        entry = entry->next;
+    }
+
+    if (entry && entry->text_hash == text_hash) {
+        cache->hit_count++;
+        output_append(capture->messages, entry->diagnostics, entry->diagnostics_size);
+        generator->diagnostics.captured_warning_count += entry->warning_count;
+        return write_file_if_changed(output_path, entry->output, entry->output_size, NULL);
+    }
+
+    cache->miss_count++;
+    size_t diagnostics_start = capture->messages->size;
+    const char* output = NULL;
+    size_t output_size = 0;
+    if (!generator_render(generator, input_path, &output, &output_size)) {
+        return false;
+    }
+
+    // Replace the stale entry or add a new one
+    if (!entry) {
+        entry = calloc(1, sizeof(cache_entry_t));
+        entry->input_path = strdup(input_path);
+        entry->next = *bucket;
+        *bucket = entry;
+    }
+    // The render belongs to the generator, so the cache keeps its own copy
+    free(entry->output);
+    entry->text_hash = text_hash;
+    entry->output = malloc(output_size ? output_size : 1);
+    memcpy(entry->output, output, output_size);
+    entry->output_size = output_size;
+    free(entry->diagnostics);
+    entry->diagnostics_size = capture->messages->size - diagnostics_start;
+    entry->diagnostics = malloc(entry->diagnostics_size ? entry->diagnostics_size : 1);
+    memcpy(entry->diagnostics, capture->messages->data + diagnostics_start, entry->diagnostics_size);
+    entry->warning_count = generator->diagnostics.captured_warning_count;
+
+    return write_file_if_changed(output_path, output, output_size, NULL);
+}
+
+static void cache_clear(render_cache_t* cache) {
+    for (int i = 0; i < CACHE_BUCKET_COUNT; i++) {
+        cache_entry_t* entry = cache->buckets[i];
+        while (entry) {
+            cache_entry_t* next = entry->next;
+            free(entry->input_path);
+            free(entry->output);
+            free(entry->diagnostics);
+            free(entry);
+            entry = next;
+        }
+        cache->buckets[i] = NULL;
+    }
+}
+
+static b8 write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+
+        data += written;
+        size -= written;
+    }
+
+    return true;
+}
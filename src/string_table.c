@@ -0,0 +1,123 @@
+#include "code_gen/string_table.h"
+
+#include <string.h>
+
+// Private data
+#define INITIAL_CAPACITY 64
+
+// Private functions
+static string_id_t add_entry(string_table_t* table, const char* text, u32 length, u32 hash);
+static u32* find_slot(const string_table_t* table, const char* text, u32 length, u32 hash);
+static void grow_slots(string_table_t* table);
+static u32 hash_string(const char* text, size_t length);
+
+// Function Impls
+void string_table_init(string_table_t* table, arena_t* arena) {
+    *table = (string_table_t) { .arena = arena };
+    table->capacity = INITIAL_CAPACITY;
+    table->entries = arena_alloc(arena, sizeof(string_entry_t) * table->capacity);
+    table->slot_mask = INITIAL_CAPACITY * 2 - 1;
+    table->slots = arena_alloc(arena, sizeof(u32) * (table->slot_mask + 1));
+    memset(table->slots, 0, sizeof(u32) * (table->slot_mask + 1));
+
+    // Id 0 is always ""
+    add_entry(table, "", 0, hash_string("", 0));
+}
+
+string_id_t string_table_intern(string_table_t* table, const char* text, size_t length) {
+    const u32 hash = hash_string(text, length);
+    u32* slot = find_slot(table, text, length, hash);
+    if (*slot) {
+        return *slot - 1;
+    }
+
+    return add_entry(table, arena_copy_string(table->arena, text, length), length, hash);
+}
+
+void string_table_write(const string_table_t* table, output_buffer_t* out) {
+    for (u32 i = 0; i < table->count; i++) {
+        output_append(out, table->entries[i].text, table->entries[i].length + 1);
+    }
+}
+
+b8 string_table_load(string_table_t* table, const char* data, size_t size, u32 count) {
+    if (count == 0 || size == 0 || data[0] != 0 || data[size - 1] != 0) {
+        return false;
+    }
+
+    // The empty string added by string_table_init is the first one in data
+    size_t offset = 1;
+    for (u32 i = 1; i < count; i++) {
+        if (offset >= size) {
+            return false;
+        }
+
+        const char* text = data + offset;
+        const u32 length = strlen(text);
+        add_entry(table, text, length, hash_string(text, length));
+        offset += length + 1;
+    }
+
+    return offset == size;
+}
+
+// Private functions
+// Adds text with the next id. Duplicates (only possible when loading) keep the slot of the first one
+static string_id_t add_entry(string_table_t* table, const char* text, u32 length, u32 hash) {
+    if (table->count >= table->capacity) {
+        u32 capacity = table->capacity * 2;
+        table->entries = arena_grow(table->arena, table->entries, sizeof(string_entry_t) * table->capacity, sizeof(string_entry_t) * capacity);
+        table->capacity = capacity;
+    }
+
+    // Slots stay at most half full so probes end quickly
+    if ((table->count + 1) * 2 > table->slot_mask + 1) {
+        grow_slots(table);
+    }
+
+    const string_id_t id = table->count++;
+    table->entries[id] = (string_entry_t) { .text = text, .length = length, .hash = hash };
+    u32* slot = find_slot(table, text, length, hash);
+    if (!*slot) {
+        *slot = id + 1;
+    }
+    return id;
+}
+
+// Returns the slot holding text, or the empty slot it would go in
+static u32* find_slot(const string_table_t* table, const char* text, u32 length, u32 hash) {
+    u32 index = hash & table->slot_mask;
+    while (table->slots[index]) {
+        const string_entry_t* entry = &table->entries[table->slots[index] - 1];
+        if (entry->hash == hash && entry->length == length && memcmp(entry->text, text, length) == 0) {
+            break;
+        }
+        index = (index + 1) & table->slot_mask;
+    }
+    return &table->slots[index];
+}
+
+static void grow_slots(string_table_t* table) {
+    const u32 slot_count = (table->slot_mask + 1) * 2;
+    table->slots = arena_alloc(table->arena, sizeof(u32) * slot_count);
+    memset(table->slots, 0, sizeof(u32) * slot_count);
+    table->slot_mask = slot_count - 1;
+
+    for (u32 id = 0; id < table->count; id++) {
+        const string_entry_t* entry = &table->entries[id];
+        u32* slot = find_slot(table, entry->text, entry->length, entry->hash);
+        if (!*slot) {
+            *slot = id + 1;
+        }
+    }
+}
+
+// FNV-1a
+static u32 hash_string(const char* text, size_t length) {
+    u32 hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)text[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
@@ -4,10 +4,6 @@
 
 #include <string.h>
 
-void write_text(const char* text, FILE* file) {
-    fwrite(text, strlen(text), 1, file);
-}
-
 b8 char_valid_in_name(char c) {
     return  (c >= 'a' && c <= 'z') || 
             (c >= 'A' && c <= 'Z') || 
@@ -15,3 +11,12 @@ b8 char_valid_in_name(char c) {
              c == '_' || c == ':';
 }
 
+u64 hash_bytes(const void* data, size_t size) {
+    const unsigned char* bytes = data;
+    u64 hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
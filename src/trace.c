@@ -0,0 +1,251 @@
+#include "code_gen/trace.h"
+#include "code_gen/file_utils.h"
+#include "code_gen/logging.h"
+#include "code_gen/output_buffer.h"
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Private structs
+// Events of one thread, already rendered as JSON. Only the owning thread appends to it.
+// Doesn't use output_buffer_t since its growth is counted as an allocation of the run being traced
+typedef struct trace_thread trace_thread_t;
+struct trace_thread {
+    trace_thread_t* next;
+    int id;
+    char* events;
+    size_t size;
+    size_t capacity;
+};
+
+// Private data
+static const char* span_names[TRACE_SPAN_KIND_COUNT] = {
+    "file", "read", "prefilter", "parse", "class", "resolve", "emit", "write",
+};
+static const char* counter_names[TRACE_COUNTER_COUNT] = {
+    "files", "lines", "classes", "exports", "groups", "bytes_in", "bytes_out", "allocations",
+};
+
+static b8 active = false;
+static char* output_path = NULL;
+static u64 start_time = 0;
+static u64 counters[TRACE_COUNTER_COUNT];
+static u64 span_counts[TRACE_SPAN_KIND_COUNT];
+static u64 span_durations[TRACE_SPAN_KIND_COUNT];
+
+// Threads register themselves on their first event. A new session makes every thread register again
+static pthread_mutex_t threads_lock = PTHREAD_MUTEX_INITIALIZER;
+static trace_thread_t* threads = NULL;
+static int thread_count = 0;
+static int session = 0;
+static _Thread_local trace_thread_t* current_thread = NULL;
+static _Thread_local int current_thread_session = 0;
+
+// Private functions
+static u64 now_nanoseconds(void);
+static trace_thread_t* get_thread(void);
+static void append(trace_thread_t* thread, const char* data, size_t size);
+static void append_format(trace_thread_t* thread, const char* format, ...) __attribute__((format(printf, 2, 3)));
+static void append_json_string(trace_thread_t* thread, const char* string);
+
+// Function Impls
+b8 trace_start(const char* path) {
+    if (active) {
+        log_error("Tracing has already started.");
+        return false;
+    }
+
+    output_path = strdup(path);
+    memset(counters, 0, sizeof(counters));
+    memset(span_counts, 0, sizeof(span_counts));
+    memset(span_durations, 0, sizeof(span_durations));
+    session++;
+    start_time = now_nanoseconds();
+    active = true;
+    return true;
+}
+
+b8 trace_stop(void) {
+    if (!active) {
+        return true;
+    }
+    active = false;
+
+    output_buffer_t out;
+    output_buffer_init(&out);
+    output_append_literal(&out, "{\"traceEvents\":[\n");
+
+    trace_thread_t* thread = threads;
+    while (thread) {
+        output_append(&out, thread->events, thread->size);
+
+        char line[128];
+        int length = snprintf(line, sizeof(line),
+                "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}},\n",
+                thread->id, thread->id);
+        output_append(&out, line, length);
+
+        trace_thread_t* next = thread->next;
+        free(thread->events);
+        free(thread);
+        thread = next;
+    }
+    threads = NULL;
+    thread_count = 0;
+    output_append_literal(&out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"source_gen\"}}\n");
+
+    // Totals for scripts that don't want to walk the events
+    output_append_literal(&out, "],\"displayTimeUnit\":\"ms\",\"stats\":{\"spans\":{");
+    for (int i = 0; i < TRACE_SPAN_KIND_COUNT; i++) {
+        char line[128];
+        int length = snprintf(line, sizeof(line), "%s\"%s\":{\"count\":%llu,\"total_ms\":%.3f}", i > 0 ? "," : "",
+                span_names[i], (unsigned long long)span_counts[i], span_durations[i] / 1e6);
+        output_append(&out, line, length);
+    }
+    output_append_literal(&out, "},\"counters\":{");
+    for (int i = 0; i < TRACE_COUNTER_COUNT; i++) {
+        char line[128];
+        int length = snprintf(line, sizeof(line), "%s\"%s\":%llu", i > 0 ? "," : "", counter_names[i], (unsigned long long)counters[i]);
+        output_append(&out, line, length);
+    }
+    output_append_literal(&out, "}}}\n");
+
+    b8 success = write_file_if_changed(output_path, out.data, out.size, NULL);
+    if (!success) {
+        log_error("Failed to write trace '%s'.", output_path);
+    }
+
+    output_buffer_free(&out);
+    free(output_path);
+    output_path = NULL;
+    return success;
+}
+
+b8 trace_active(void) {
+    return active;
+}
+
+trace_span_t trace_begin(trace_span_kind_t kind) {
+    return (trace_span_t) { .kind = kind, .start = active ? now_nanoseconds() : 0, };
+}
+
+void trace_end(trace_span_t span, const char* detail) {
+    if (!active || span.start == 0) {
+        return;
+    }
+
+    u64 end = now_nanoseconds();
+    __atomic_fetch_add(&span_counts[span.kind], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&span_durations[span.kind], end - span.start, __ATOMIC_RELAXED);
+
+    // Timestamps are in microseconds since the trace started
+    trace_thread_t* thread = get_thread();
+    append_format(thread, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+            span_names[span.kind], thread->id, (span.start - start_time) / 1e3, (end - span.start) / 1e3);
+    if (detail) {
+        append(thread, ",\"args\":{\"detail\":", sizeof(",\"args\":{\"detail\":") - 1);
+        append_json_string(thread, detail);
+        append(thread, "}", 1);
+    }
+    append(thread, "},\n", 3);
+}
+
+void trace_count(trace_counter_t counter, u64 value) {
+    if (active) {
+        __atomic_fetch_add(&counters[counter], value, __ATOMIC_RELAXED);
+    }
+}
+
+void trace_sample_counters(void) {
+    if (!active) {
+        return;
+    }
+
+    // One event per counter so each gets its own track instead of being stacked
+    trace_thread_t* thread = get_thread();
+    double timestamp = (now_nanoseconds() - start_time) / 1e3;
+    for (int i = 0; i < TRACE_COUNTER_COUNT; i++) {
+        append_format(thread, "{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{\"value\":%llu}},\n",
+                counter_names[i], thread->id, timestamp, (unsigned long long)__atomic_load_n(&counters[i], __ATOMIC_RELAXED));
+    }
+}
+
+// Private functions
+static u64 now_nanoseconds(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (u64)time.tv_sec * 1000000000ull + time.tv_nsec;
+}
+
+static trace_thread_t* get_thread(void) {
+    if (current_thread && current_thread_session == session) {
+        return current_thread;
+    }
+
+    trace_thread_t* thread = calloc(1, sizeof(trace_thread_t));
+    if (!thread) {
+        log_fatal("Failed to allocate trace thread.");
+    }
+
+    pthread_mutex_lock(&threads_lock);
+    thread->id = ++thread_count;
+    thread->next = threads;
+    threads = thread;
+    pthread_mutex_unlock(&threads_lock);
+
+    current_thread = thread;
+    current_thread_session = session;
+    return thread;
+}
+
+static void append(trace_thread_t* thread, const char* data, size_t size) {
+    if (thread->size + size > thread->capacity) {
+        size_t capacity = thread->capacity ? thread->capacity : 16 * 1024;
+        while (capacity < thread->size + size) {
+            capacity *= 2;
+        }
+
+        char* events = realloc(thread->events, capacity);
+        if (!events) {
+            log_fatal("Failed to grow trace buffer to %zu bytes.", capacity);
+        }
+        thread->events = events;
+        thread->capacity = capacity;
+    }
+
+    memcpy(thread->events + thread->size, data, size);
+    thread->size += size;
+}
+
+static void append_format(trace_thread_t* thread, const char* format, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    if (length > 0) {
+        append(thread, line, length < (int)sizeof(line) ? (size_t)length : sizeof(line) - 1);
+    }
+}
+
+static void append_json_string(trace_thread_t* thread, const char* string) {
+    append(thread, "\"", 1);
+    for (const char* c = string; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            char escaped[2] = { '\\', *c };
+            append(thread, escaped, 2);
+        } else if ((unsigned char)*c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)*c);
+            append(thread, escaped, 6);
+        } else {
+            append(thread, c, 1);
+        }
+    }
+    append(thread, "\"", 1);
+}